@@ -10,6 +10,9 @@
 #import "NonogramView.hpp"
 #import "Parser.hpp"
 #import "Classifier.hpp"
+#import "HintEngine.hpp"
+#import "Validator.hpp"
+#import "Portfolio.hpp"
 
 #import "GCDTimer.h"
 
@@ -17,6 +20,8 @@
 #include <string>
 #include <sstream>
 #include <unordered_map>
+#include <memory>
+#include <thread>
 
 
 enum NonogramDifficulty {
@@ -31,6 +36,13 @@ enum NonogramDifficulty {
 	                                   // the current configuration of the table!
 	Nonogram::Table table;
 
+	// Lazily created for 'constraints'; remembers line
+	// state between consecutive hint requests
+	std::unique_ptr<HintEngine> hintEngine;
+
+	// Checks the uniqueness of the table being drawn in the background
+	std::unique_ptr<BackgroundValidator> validator;
+
 	NSMenuItem *newItem;
 	NSMenuItem *openItem;
 	NSMenuItem *saveItem;
@@ -39,6 +51,8 @@ enum NonogramDifficulty {
 	NSMenuItem *completeToUniqueItem;
 	NSMenuItem *showStepsItem;
 	NSMenuItem *classifyItem;
+	NSMenuItem *hintItem;
+	NSMenuItem *backboneItem;
 }
 
 @property (weak) IBOutlet NSWindow *window;
@@ -61,6 +75,12 @@ enum NonogramDifficulty {
 	self.nonogramView.delegate = self;
 	self.canvas.documentView = self.nonogramView;
 
+	validator.reset(new BackgroundValidator([=](Validator::Status status) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[self showValidationStatus:status];
+		});
+	}));
+
 	// Set up file access menus
 	NSMenu *mainMenu = [[NSApplication sharedApplication] mainMenu];
 	NSMenu *fileMenu = [[mainMenu itemAtIndex:1] submenu];
@@ -90,6 +110,12 @@ enum NonogramDifficulty {
 
 	classifyItem = [[NSMenuItem alloc] initWithTitle:@"Classify difficulty" action:@selector(classifyMenuClicked) keyEquivalent:@"d"];
 	classifyItem.target = self;
+
+	hintItem = [[NSMenuItem alloc] initWithTitle:@"Show Hint" action:@selector(hintMenuClicked) keyEquivalent:@"i"];
+	hintItem.target = self;
+
+	backboneItem = [[NSMenuItem alloc] initWithTitle:@"Show Ambiguous Cells" action:@selector(backboneMenuClicked) keyEquivalent:@"b"];
+	backboneItem.target = self;
 	
 	[fileMenu addItem:newItem];
 	[fileMenu addItem:openItem];
@@ -99,6 +125,8 @@ enum NonogramDifficulty {
 	[fileMenu addItem:completeToUniqueItem];
 	[fileMenu addItem:showStepsItem];
 	[fileMenu addItem:classifyItem];
+	[fileMenu addItem:hintItem];
+	[fileMenu addItem:backboneItem];
 }
 
 // Indicate to user that the puzzle is being solved
@@ -112,6 +140,8 @@ enum NonogramDifficulty {
 	completeToUniqueItem.action = @selector(completeToUniqueMenuClicked);
 	showStepsItem.action = @selector(showStepsMenuClicked);
 	classifyItem.action = @selector(classifyMenuClicked);
+	hintItem.action = @selector(hintMenuClicked);
+	backboneItem.action = @selector(backboneMenuClicked);
 }
 
 - (void)disableMenuItems {
@@ -123,6 +153,8 @@ enum NonogramDifficulty {
 	completeToUniqueItem.action = NULL; // also that ^^
 	showStepsItem.action = NULL;
 	classifyItem.action = NULL;
+	hintItem.action = NULL;
+	backboneItem.action = NULL;
 }
 
 - (NSTextField *)textLabelWithFrame:(NSRect)f text:(NSString *)text {
@@ -207,7 +239,9 @@ enum NonogramDifficulty {
 		}
 
 		table = Nonogram::Table(rows, std::vector<Nonogram::Cell>(cols, Nonogram::CELL_WHITE));
+		hintEngine.reset();
 		[self.nonogramView reload];
+		validator->tableChanged(table);
 	}
 }
 
@@ -241,6 +275,7 @@ enum NonogramDifficulty {
 					auto maybeConstraints = parser.parseConstraints(src);
 					if (maybeConstraints) {
 						constraints = maybeConstraints.value;
+						hintEngine.reset();
 						std::size_t rows = constraints.rows.size();
 						std::size_t cols = constraints.cols.size();
 
@@ -253,6 +288,7 @@ enum NonogramDifficulty {
 						}
 
 						[self.nonogramView reload];
+						validator->tableChanged(table);
 					} else {
 						runFileFormatCorruptedDialog();
 					}
@@ -276,7 +312,9 @@ enum NonogramDifficulty {
 						}
 
 						table = maybeTable.value;
+						hintEngine.reset();
 						[self.nonogramView reload];
+						validator->tableChanged(table);
 					} else {
 						runFileFormatCorruptedDialog();
 					}
@@ -351,9 +389,13 @@ enum NonogramDifficulty {
 	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
 		// search for at least 2 solutions
 		// in order to decide uniqueness
+		// (the table is one of them, so let the search try it first)
 		auto localConstr = Nonogram::constraintsFromTable(savedTable);
+		Nonogram::SolveOptions options;
+		options.hint = &savedTable;
+
 		Nonogram n(localConstr);
-		auto solutions = n.solve(2);
+		auto solutions = n.solve(2, nullptr, options);
 
 		dispatch_async(dispatch_get_main_queue(), ^{
 			[self enableMenuItems];
@@ -379,11 +421,11 @@ enum NonogramDifficulty {
 
 	// solve puzzle in the background
 	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-		Nonogram n(constraints);
-
-		// search for at least 2 solutions
-		// in order to decide uniqueness
-		auto solutions = n.solve(2);
+		// Race differently configured searches on all cores,
+		// since the best one varies a lot from puzzle to puzzle.
+		// Search for at least 2 solutions in order to decide uniqueness
+		auto configs = defaultPortfolio(std::max(1u, std::thread::hardware_concurrency()));
+		auto solutions = solvePortfolio(constraints, configs, 2).solutions;
 		
 		dispatch_async(dispatch_get_main_queue(), ^{
 			[self enableMenuItems];
@@ -397,6 +439,7 @@ enum NonogramDifficulty {
 			}
 
 			[self.nonogramView reload];
+			validator->tableChanged(table);
 
 			// Inform user of solutions
 			[self runNumberOfSolutionsAlert:solutions.size()];
@@ -418,7 +461,14 @@ enum NonogramDifficulty {
 	//   until a unique solution is found.
 
 	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-		auto solutions = Nonogram(Nonogram::constraintsFromTable(table)).solve(2);
+		// Each puzzle is the previous one with a single cell flipped, and
+		// the table it was made from is one of its solutions; starting
+		// the search from it saves most of the work of re-solving.
+		Nonogram::Table current = table;
+		Nonogram::SolveOptions options;
+		options.hint = &current;
+
+		auto solutions = Nonogram(Nonogram::constraintsFromTable(current)).solve(2, nullptr, options);
 
 		while (solutions.size() > 1) {
 			auto next = solutions[0];
@@ -444,12 +494,14 @@ enum NonogramDifficulty {
 				[self.nonogramView reload];
 			});
 
-			solutions = Nonogram(Nonogram::constraintsFromTable(next)).solve(2);
+			current = next;
+			solutions = Nonogram(Nonogram::constraintsFromTable(current)).solve(2, nullptr, options);
 		}
 
 		dispatch_async(dispatch_get_main_queue(), ^{
 			[self enableMenuItems];
 			self.nonogramView.interactionEnabled = YES;
+			validator->tableChanged(table);
 
 			[[NSAlert alertWithMessageText:@"Converted to unique solution"
 	                                 defaultButton:@"OK"
@@ -481,6 +533,7 @@ enum NonogramDifficulty {
 			if (solutions.empty()) {
 				[self runNumberOfSolutionsAlert:solutions.size() /* 0 */];
 				self.nonogramView.interactionEnabled = YES;
+				validator->tableChanged(table);
 				[self enableMenuItems];
 			} else {
 				// If we have found a solution, then cycle through its steps
@@ -502,6 +555,7 @@ enum NonogramDifficulty {
 						[self enableMenuItems];
 						table = solutions[0];
 						[self.nonogramView reload];
+						validator->tableChanged(table);
 						self.nonogramView.interactionEnabled = YES;
 					}
 				} afterInterval:interval repeat:YES];
@@ -510,46 +564,6 @@ enum NonogramDifficulty {
 	});
 }
 
-- (BOOL)hasUnequivocallyBlackOrWhiteCells:(const std::vector<std::vector<std::vector<Nonogram::Cell>>> &)lineConfigs lineLength:(std::size_t)lineLength {
-	for (std::size_t i = 0; i < lineConfigs.size(); i++) {
-		// i-th line (row or column)
-		std::vector<Nonogram::Cell> surelyBlack(lineLength, Nonogram::CELL_BLACK);
-		std::vector<Nonogram::Cell> surelyWhite(lineLength, Nonogram::CELL_WHITE);
-
-		for (std::size_t j = 0; j < lineConfigs[i].size(); j++) {
-			// j-th configuration
-			for (std::size_t k = 0; k < lineConfigs[i][j].size(); k++) {
-				// k-th cell
-				if (lineConfigs[i][j][k] == Nonogram::CELL_WHITE) {
-					// was white once -> cannot always be black
-					surelyBlack[k] = Nonogram::CELL_WHITE;
-				}
-				if (lineConfigs[i][j][k] == Nonogram::CELL_BLACK) {
-					// was black once -> cannot always be white
-					surelyWhite[k] = Nonogram::CELL_BLACK;
-				}
-			}
-		}
-
-		// Found any unequivocally-black cells
-		if (std::any_of(surelyBlack.begin(), surelyBlack.end(), [=](Nonogram::Cell cell) {
-			return cell == Nonogram::CELL_BLACK;
-		})) {
-			return YES;
-		}
-
-		// Found any unequivocally-white cells
-		if (std::any_of(surelyWhite.begin(), surelyWhite.end(), [=](Nonogram::Cell cell) {
-			return cell == Nonogram::CELL_WHITE;
-		})) {
-			return YES;
-		}
-	}
-
-	// Not found any unequivocally black or white rows
-	return NO;
-}
-
 - (NonogramDifficulty)difficultyOfConstraints:(const Nonogram::Constraints &)c {
 	// Generate all possible combinations for rows and columns
 	// If both rows and columns have a unique solution on their own,
@@ -571,13 +585,13 @@ enum NonogramDifficulty {
 	}
 
 	// Else, if there are cells which can be determined to be either
-	// black or white by trying every possible combination, then
+	// black or white by looking at a single line, then
 	// the problem can most likely be approached heuristically
-	if ([self hasUnequivocallyBlackOrWhiteCells:rowConfigs lineLength:c.cols.size()]) {
+	if (anyLineHasForcedCells(c.cols.size(), c.rows)) {
 		return DIFFICULTY_HEURISTIC;
 	}
 
-	if ([self hasUnequivocallyBlackOrWhiteCells:colConfigs lineLength:c.rows.size()]) {
+	if (anyLineHasForcedCells(c.rows.size(), c.cols)) {
 		return DIFFICULTY_HEURISTIC;
 	}
 
@@ -599,6 +613,76 @@ enum NonogramDifficulty {
 	[alert runModal];
 }
 
+// Reveal the next cells that follow from the current
+// state of the table by looking at a single line
+- (void)hintMenuClicked {
+	std::size_t rows = constraints.rows.size();
+	std::size_t cols = constraints.cols.size();
+
+	// If the table doesn't belong to the puzzle, start from scratch
+	if (table.size() != rows or (rows and table[0].size() != cols)) {
+		table = Nonogram::Table(rows, std::vector<Nonogram::Cell>(cols, Nonogram::CELL_UNKNOWN));
+	}
+
+	if (not hintEngine) {
+		hintEngine.reset(new HintEngine(constraints));
+	}
+
+	auto hint = hintEngine->nextHint(table);
+	NSString *lineName = hint.isRow ? @"row" : @"column";
+
+	switch (hint.status) {
+	case HintEngine::Hint::HINT_FOUND:
+		for (const auto &cell : hint.cells) {
+			table[cell.row][cell.col] = cell.value;
+		}
+		[self.nonogramView reload];
+		validator->tableChanged(table);
+		break;
+	case HintEngine::Hint::HINT_NONE:
+		[[NSAlert alertWithMessageText:@"No hint available"
+		                 defaultButton:@"OK"
+		               alternateButton:nil
+		                   otherButton:nil
+		     informativeTextWithFormat:@"No single row or column determines any more cells."] runModal];
+		break;
+	case HintEngine::Hint::HINT_CONTRADICTION:
+		[[NSAlert alertWithMessageText:@"Contradiction"
+		                 defaultButton:@"OK"
+		               alternateButton:nil
+		                   otherButton:nil
+		     informativeTextWithFormat:@"The %@ #%zu can't be completed anymore.", lineName, hint.line + 1] runModal];
+		break;
+	}
+}
+
+// Show the cells that are the same in every solution,
+// leaving the ambiguous ones gray (unknown)
+- (void)backboneMenuClicked {
+	table = {};
+
+	[self disableMenuItems];
+	[self.nonogramView startGlowAnimation];
+
+	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+		Nonogram n(constraints);
+		auto forced = n.backbone();
+
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[self enableMenuItems];
+			[self.nonogramView stopGlowAnimation];
+
+			table = forced;
+			[self.nonogramView reload];
+			validator->tableChanged(table);
+
+			if (forced.empty()) {
+				[self runNumberOfSolutionsAlert:0];
+			}
+		});
+	});
+}
+
 
 // NonogramViewDelegate
 
@@ -607,7 +691,17 @@ enum NonogramDifficulty {
 }
 
 - (void)nonogramViewChanged:(NonogramView *)nv {
-	// may be required to do something here in the future...
+	validator->tableChanged(table);
+}
+
+- (void)showValidationStatus:(Validator::Status)status {
+	static std::unordered_map<Validator::Status, NSString *, std::hash<int>> statusStrings {
+		{ Validator::STATUS_UNSOLVED,  @"checking..." },
+		{ Validator::STATUS_UNIQUE,    @"unique"      },
+		{ Validator::STATUS_AMBIGUOUS, @"ambiguous"   }
+	};
+
+	self.window.title = [NSString stringWithFormat:@"NonogramSolver (%@)", statusStrings[status]];
 }
 
 @end
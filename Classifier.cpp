@@ -9,8 +9,12 @@
 
 #include "Classifier.hpp"
 #include "Support.hpp"
+#include "Verifier.hpp"
+#include "LineCache.hpp"
+#include "Trace.hpp"
 
 #include <vector>
+#include <algorithm>
 #include <thread>
 #include <future>
 #include <cassert>
@@ -27,40 +31,109 @@
 //
 // 'selected' is the number of contiguous black blocks in the sequence
 // 'blockSizes' contains the length of each such block in turn.
-// 'blockSizeIndex' is used to select the appropriate next block size
-// from the blockSizes array when calling rowConfigs recursively.
-static
-std::vector<std::vector<Nonogram::Cell>>
-lineConfigs(int total, int selected, const std::vector<int> &blockSizes, int blockSizeIndex, int maxNumOfConfigsPerLine)
-{
-	if (selected == 0) {
-		return { std::vector<Nonogram::Cell>(total) };
+//
+// The combinations are generated lazily, one at a time, in the order
+// of the recursion above: 'positions' holds the indices of the selected
+// cells in increasing order, and stepping to the next combination is the
+// usual "increment the last index that can still be incremented" step.
+// Combinations with two adjacent selected cells are skipped right away,
+// since their blocks would merge (see below); enumerating and discarding
+// them took exponential time on lines with many blocks.
+// Each state is written into the same buffer, so this is a single-pass
+// range: a state is only valid until the iterator is incremented.
+class LineConfigs {
+protected:
+	int total;
+	const std::vector<int> &blockSizes;
+	std::vector<int> positions;
+	std::vector<Nonogram::Cell> line;
+	bool done;
+
+	// Expand the selected cells into blocks
+	void render() {
+		std::size_t cell = 0;
+		std::size_t block = 0;
+
+		for (int i = 0; i < total; i++) {
+			if (block < positions.size() and positions[block] == i) {
+				std::fill_n(line.begin() + cell, blockSizes[block], Nonogram::CELL_BLACK);
+				cell += blockSizes[block];
+				block++;
+			} else {
+				line[cell++] = Nonogram::CELL_WHITE;
+			}
+		}
 	}
 
-	if (total == 0) {
-		return {};
-	}
+	void advance() {
+		// The selected cells after #i need (selected - 1 - i) * 2 cells
+		int selected = int(positions.size());
+		int i = selected - 1;
 
-	auto selectedConfigs = lineConfigs(total - 1, selected - 1, blockSizes, blockSizeIndex + 1, maxNumOfConfigsPerLine);
-	auto subSelected = _map(selectedConfigs, [=](std::vector<Nonogram::Cell> seq) {
-		std::vector<Nonogram::Cell> allBlack(blockSizes[blockSizeIndex], Nonogram::CELL_BLACK);
-		seq.insert(seq.begin(), allBlack.begin(), allBlack.end());
-		return seq;
-	});
+		while (i >= 0 and positions[i] >= total - 1 - 2 * (selected - 1 - i)) {
+			i--;
+		}
+
+		if (i < 0) {
+			done = true;
+			return;
+		}
+
+		positions[i]++;
+		for (int k = i + 1; k < selected; k++) {
+			positions[k] = positions[k - 1] + 2;
+		}
 
-	if (subSelected.size() > maxNumOfConfigsPerLine) {
-		return subSelected;
+		render();
 	}
 
-	auto unselectedConfigs = lineConfigs(total - 1, selected, blockSizes, blockSizeIndex, maxNumOfConfigsPerLine);
-	auto subUnselected = _map(unselectedConfigs, [=](std::vector<Nonogram::Cell> seq) {
-		seq.insert(seq.begin(), Nonogram::CELL_WHITE);
-		return seq;
-	});
+public:
+	class iterator {
+	protected:
+		LineConfigs *configs; // nullptr for the end iterator
 
-	subSelected.insert(subSelected.end(), subUnselected.begin(), subUnselected.end());
-	return subSelected;
-}
+		bool atEnd() const { return not configs or configs->done; }
+
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef std::vector<Nonogram::Cell> value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const value_type *pointer;
+		typedef const value_type &reference;
+
+		iterator(LineConfigs *c) : configs(c) {}
+
+		reference operator*() const { return configs->line; }
+
+		iterator &operator++() {
+			configs->advance();
+			return *this;
+		}
+
+		bool operator==(const iterator &other) const { return atEnd() == other.atEnd(); }
+		bool operator!=(const iterator &other) const { return atEnd() != other.atEnd(); }
+	};
+
+	// 'total' must be lineLength - SUM(blockSizes) + blockSizes.size()
+	LineConfigs(int t, int lineLength, const std::vector<int> &bs) :
+		total(t),
+		blockSizes(bs),
+		positions(bs.size()),
+		line(std::max(lineLength, 0)),
+		done(t < 2 * int(bs.size()) - 1)
+	{
+		for (std::size_t k = 0; k < positions.size(); k++) {
+			positions[k] = int(2 * k);
+		}
+
+		if (not done) {
+			render();
+		}
+	}
+
+	iterator begin() { return iterator(this); }
+	iterator end() { return iterator(nullptr); }
+};
 
 // This filters out only the row configurations that satisfy the clues
 // A 'line' is either a row or a column of the puzzle.
@@ -68,6 +141,8 @@ static
 std::vector<std::vector<Nonogram::Cell>>
 possibleLineConfigs(int lineLength, const std::vector<int> &blocks, int maxNumOfConfigsPerLine)
 {
+	NONOGRAM_TRACE_SCOPE("possibleLineConfigs");
+
 	// n is the number of black BLOCKS
 	int n = blocks.size();
 
@@ -84,38 +159,31 @@ possibleLineConfigs(int lineLength, const std::vector<int> &blocks, int maxNumOf
 	// or unselected (==white), and there are n blocks to select; consequently,
 	// we need to generate all combinations [BINOM(F + n, n)].
 	// Then, we need to get rid of the configurations where two black boxes follow
-	// immediately, because that's prohibited by definition.
+	// immediately, because that's prohibited by definition (LineConfigs doesn't
+	// even generate those, but the filter below states what we're after).
 	int F = lineLength - sum<int>(blocks);
 
-	auto configs = lineConfigs(F + n, n, blocks, 0, maxNumOfConfigsPerLine);
+	LineConfigs configs(F + n, lineLength, blocks);
 
-	return filter(configs, [=](const std::vector<Nonogram::Cell> &seq) {
-		std::size_t i = 0;
-		std::vector<int> blockSizes;
+	// Keep the configurations whose blocks are exactly the clues
+	// (two adjacent blocks would merge into a single, longer one)
+	auto matching = filtered(configs, [&](const std::vector<Nonogram::Cell> &seq) {
+		return Verifier::lineMatches(seq, blocks);
+	});
 
-		// Count consecutive black cells
-		while (i < seq.size()) {
-			int consec = 0;
-			while (i < seq.size() and seq[i]) {
-				i++;
-				consec++;
-			}
+	// Only the configurations we keep are copied, and
+	// we stop generating them once we have enough
+	std::vector<std::vector<Nonogram::Cell>> result;
 
-			if (i > 0) {
-				blockSizes.push_back(consec);
-			}
-
-			while (i < seq.size() and not seq[i]) {
-				i++;
-			}
-		}
+	for (const auto &seq : matching) {
+		result.push_back(seq);
 
-		if (blockSizes.size() == 0) {
-			blockSizes.push_back(0);
+		if (result.size() >= std::size_t(maxNumOfConfigsPerLine)) {
+			break;
 		}
+	}
 
-		return blockSizes == blocks;
-	});
+	return result;
 }
 
 std::vector<std::vector<std::vector<Nonogram::Cell>>>
@@ -125,6 +193,8 @@ configsForAllLines(
 	int maxNumOfConfigsPerLine
 )
 {
+	NONOGRAM_TRACE_SCOPE("configsForAllLines");
+
 	std::vector<std::future<std::vector<std::vector<Nonogram::Cell>>>> fs;
 
 	// Launch computation of possible row configurations asynchronously
@@ -143,3 +213,31 @@ configsForAllLines(
 
 	return result;
 }
+
+bool
+anyLineHasForcedCells(
+	int lineLength,
+	const std::vector<std::vector<int>> &blockSizes
+)
+{
+	NONOGRAM_TRACE_SCOPE("anyLineHasForcedCells");
+
+	LineSolver solver;
+	LineSolver::Line line;
+
+	for (const auto &lineDesc : blockSizes) {
+		line.assign(lineLength, Nonogram::CELL_UNKNOWN);
+
+		if (not LineCache::shared().solve(solver, lineDesc, line)) {
+			continue;
+		}
+
+		if (std::any_of(line.begin(), line.end(), [](Nonogram::Cell cell) {
+			return cell != Nonogram::CELL_UNKNOWN;
+		})) {
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -11,6 +11,8 @@
 
 #include "Nonogram.hpp"
 
+// The configurations of each line of 'lineLength' cells that satisfy
+// its clues in 'blockSizes', at most maxNumOfConfigsPerLine of them
 std::vector<std::vector<std::vector<Nonogram::Cell>>>
 configsForAllLines(
 	int lineLength,
@@ -18,4 +20,13 @@ configsForAllLines(
 	int maxNumOfConfigsPerLine
 );
 
+// True if some cell of an empty line of 'lineLength' cells is black
+// (or white) in every placement of one of the clue lists in 'blockSizes'.
+// Uses the shared LineCache, so it's practically free the second time.
+bool
+anyLineHasForcedCells(
+	int lineLength,
+	const std::vector<std::vector<int>> &blockSizes
+);
+
 #endif // NONOGRAM_CLASSIFIER_HPP
@@ -0,0 +1,70 @@
+//
+// DfaCache.cpp
+// Interned, compiled DFAs of line constraints
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include "DfaCache.hpp"
+#include "Nonogram.hpp"
+#include "Trace.hpp"
+
+
+thread_local DfaCache::Shard DfaCache::shard;
+std::atomic<std::size_t> DfaCache::size(0);
+std::atomic<std::size_t> DfaCache::hits(0);
+std::atomic<std::size_t> DfaCache::misses(0);
+
+DfaCache::Shard::~Shard() {
+	clear();
+}
+
+void DfaCache::Shard::clear() {
+	size -= dfas.size();
+	dfas.clear();
+}
+
+Gecode::DFA DfaCache::get(const std::vector<int> &clues, bool *hit) {
+	auto it = shard.dfas.find(clues);
+	if (it != shard.dfas.end()) {
+		hits++;
+
+		if (hit) {
+			*hit = true;
+		}
+
+		return it->second;
+	}
+
+	misses++;
+
+	if (hit) {
+		*hit = false;
+	}
+
+	if (shard.dfas.size() >= maxShardSize) {
+		shard.clear();
+	}
+
+	// Compiling a DFA is the expensive part
+	NONOGRAM_TRACE_SCOPE("compile DFA");
+	Gecode::DFA dfa(Nonogram::buildRegexForLine(clues));
+	shard.dfas.insert({ clues, dfa });
+	size++;
+
+	return dfa;
+}
+
+DfaCache::Statistics DfaCache::statistics() {
+	return { hits, misses, size };
+}
+
+void DfaCache::resetStatistics() {
+	hits = 0;
+	misses = 0;
+}
+
+void DfaCache::clear() {
+	shard.clear();
+}
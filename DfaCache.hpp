@@ -0,0 +1,75 @@
+//
+// DfaCache.hpp
+// Interned, compiled DFAs of line constraints
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#ifndef NONOGRAM_DFACACHE_HPP
+#define NONOGRAM_DFACACHE_HPP
+
+#include <vector>
+#include <map>
+#include <atomic>
+#include <cstddef>
+
+#include <gecode/int.hh>
+#include <gecode/minimodel.hh>
+
+// Real puzzles repeat clues a lot (empty lines, full lines, identical
+// rows...), so instead of compiling the same regular expression into
+// a DFA over and over again, the compiled DFAs are kept around and
+// handed out to every Nonogram that needs them.
+//
+// The key is the clue list alone: the regular expression of a line
+// doesn't depend on its length, so lines of different length can
+// share a DFA just fine.
+//
+// Gecode::DFA is a reference counted handle, and with the Gecode
+// versions we build against (those with the 'share' flag in cloning),
+// the reference count is not atomic. So each thread gets its own
+// thread_local shard of the cache: a DFA is only ever copied and
+// released by the thread that compiled it, no lock is needed, and
+// the shard is freed when its thread exits. (A thread_local with a
+// destructor needs Xcode 8 and OS X 10.11 or later, see the README.)
+class DfaCache {
+public:
+	struct Statistics {
+		std::size_t hits;
+		std::size_t misses;
+		std::size_t size; // number of DFAs in the cache, all threads
+	};
+
+protected:
+	// Keeps the global DFA count in sync, including at thread exit
+	struct Shard {
+		std::map<std::vector<int>, Gecode::DFA> dfas;
+
+		~Shard();
+		void clear();
+	};
+
+	// Upper bound on the number of DFAs per thread; a shard
+	// that grows larger than this is simply emptied.
+	static const std::size_t maxShardSize = 4096;
+
+	static thread_local Shard shard;
+	static std::atomic<std::size_t> size;
+	static std::atomic<std::size_t> hits;
+	static std::atomic<std::size_t> misses;
+
+public:
+	// Returns the DFA accepting exactly the lines described by 'clues',
+	// compiling it if needed. If 'hit' is non-null, it's set to whether
+	// the DFA came from the cache.
+	static Gecode::DFA get(const std::vector<int> &clues, bool *hit = nullptr);
+
+	static Statistics statistics();
+	static void resetStatistics();
+
+	// Only drops the DFAs of the calling thread (see above)
+	static void clear();
+};
+
+#endif // NONOGRAM_DFACACHE_HPP
@@ -0,0 +1,186 @@
+//
+// HintEngine.cpp
+// "Next logical move" hints for partially filled tables
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include "HintEngine.hpp"
+#include "LineCache.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+const std::size_t HintEngine::historyLength;
+
+HintEngine::HintEngine(const Nonogram::Constraints &c) :
+	constraints(c),
+	rowStates(c.rows.size()),
+	colStates(c.cols.size())
+{}
+
+void HintEngine::setRowClues(std::size_t i, const std::vector<int> &clues) {
+	if (constraints.rows[i] != clues) {
+		constraints.rows[i] = clues;
+		rowStates[i].results.clear();
+	}
+}
+
+void HintEngine::setColClues(std::size_t j, const std::vector<int> &clues) {
+	if (constraints.cols[j] != clues) {
+		constraints.cols[j] = clues;
+		colStates[j].results.clear();
+	}
+}
+
+const HintEngine::LineResult &
+HintEngine::update(LineState &state, const std::vector<int> &clues, const LineSolver::Line &current) {
+	auto &results = state.results;
+
+	for (std::size_t k = 0; k < results.size(); k++) {
+		if (results[k].input == current) {
+			std::rotate(results.begin(), results.begin() + k, results.begin() + k + 1);
+			return results[0];
+		}
+	}
+
+	// Reuse the storage of the least recently used result
+	if (results.size() < historyLength) {
+		results.emplace_back();
+	}
+
+	std::rotate(results.begin(), results.end() - 1, results.end());
+
+	auto &result = results[0];
+	result.input = current;
+	result.output = current;
+	result.consistent = LineCache::shared().solve(solver, clues, result.output);
+
+	return result;
+}
+
+HintEngine::Hint HintEngine::nextHint(const Nonogram::Table &table) {
+	std::size_t rows = constraints.rows.size();
+	std::size_t cols = constraints.cols.size();
+
+	assert(table.size() == rows);
+
+	// Collects the cells a line can tell us, but we don't know yet
+	auto makeHint = [&](const LineResult &state, bool isRow, std::size_t index) {
+		Hint hint { Hint::HINT_NONE, isRow, index, {} };
+
+		if (not state.consistent) {
+			hint.status = Hint::HINT_CONTRADICTION;
+			return hint;
+		}
+
+		for (std::size_t k = 0; k < state.input.size(); k++) {
+			if (state.input[k] == Nonogram::CELL_UNKNOWN and state.output[k] != Nonogram::CELL_UNKNOWN) {
+				std::size_t row = isRow ? index : k;
+				std::size_t col = isRow ? k : index;
+				hint.cells.push_back({ row, col, state.output[k] });
+			}
+		}
+
+		if (hint.cells.size()) {
+			hint.status = Hint::HINT_FOUND;
+		}
+
+		return hint;
+	};
+
+	for (std::size_t i = 0; i < rows; i++) {
+		assert(table[i].size() == cols);
+
+		const auto &state = update(rowStates[i], constraints.rows[i], table[i]);
+		auto hint = makeHint(state, true, i);
+		if (hint.status != Hint::HINT_NONE) {
+			return hint;
+		}
+	}
+
+	scratch.resize(rows);
+
+	for (std::size_t j = 0; j < cols; j++) {
+		for (std::size_t i = 0; i < rows; i++) {
+			scratch[i] = table[i][j];
+		}
+
+		const auto &state = update(colStates[j], constraints.cols[j], scratch);
+		auto hint = makeHint(state, false, j);
+		if (hint.status != Hint::HINT_NONE) {
+			return hint;
+		}
+	}
+
+	return { Hint::HINT_NONE, true, 0, {} };
+}
+
+bool HintEngine::propagate(Nonogram::Table &table) {
+	std::size_t rows = constraints.rows.size();
+	std::size_t cols = constraints.cols.size();
+
+	assert(table.size() == rows);
+
+	// A line needs to be looked at again if a cell of it
+	// has been filled in by a line of the other dimension
+	std::vector<bool> dirtyRows(rows, true);
+	std::vector<bool> dirtyCols(cols, true);
+	bool changed = true;
+
+	scratch.resize(rows);
+
+	while (changed) {
+		changed = false;
+
+		for (std::size_t i = 0; i < rows; i++) {
+			if (not dirtyRows[i]) {
+				continue;
+			}
+
+			dirtyRows[i] = false;
+
+			const auto &state = update(rowStates[i], constraints.rows[i], table[i]);
+			if (not state.consistent) {
+				return false;
+			}
+
+			for (std::size_t j = 0; j < cols; j++) {
+				if (table[i][j] != state.output[j]) {
+					table[i][j] = state.output[j];
+					dirtyCols[j] = true;
+					changed = true;
+				}
+			}
+		}
+
+		for (std::size_t j = 0; j < cols; j++) {
+			if (not dirtyCols[j]) {
+				continue;
+			}
+
+			dirtyCols[j] = false;
+
+			for (std::size_t i = 0; i < rows; i++) {
+				scratch[i] = table[i][j];
+			}
+
+			const auto &state = update(colStates[j], constraints.cols[j], scratch);
+			if (not state.consistent) {
+				return false;
+			}
+
+			for (std::size_t i = 0; i < rows; i++) {
+				if (table[i][j] != state.output[i]) {
+					table[i][j] = state.output[i];
+					dirtyRows[i] = true;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	return true;
+}
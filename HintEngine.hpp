@@ -0,0 +1,97 @@
+//
+// HintEngine.hpp
+// "Next logical move" hints for partially filled tables
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#ifndef NONOGRAM_HINTENGINE_HPP
+#define NONOGRAM_HINTENGINE_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "Nonogram.hpp"
+#include "LineSolver.hpp"
+
+// The HintEngine answers the question "which cells follow from the
+// current state of the table by looking at a single line?" without
+// building a Gecode model. It remembers what it has learnt about each
+// line, so consecutive calls only re-solve the lines that changed.
+// Create one per puzzle (i. e. set of constraints) and keep it around.
+class HintEngine {
+public:
+	struct Deduction {
+		std::size_t row;
+		std::size_t col;
+		Nonogram::Cell value;
+	};
+
+	struct Hint {
+		enum Status {
+			HINT_FOUND,        // 'cells' are forced by line #'line'
+			HINT_NONE,         // line logic alone can't make progress
+			HINT_CONTRADICTION // line #'line' can't be satisfied at all
+		};
+
+		Status status;
+		bool isRow;
+		std::size_t line;
+		std::vector<Deduction> cells;
+	};
+
+protected:
+	// What we know about a line from a time we solved it:
+	// the known cells we solved it with, and what they implied.
+	// If the line in the table looks like 'input' again,
+	// 'output' is still valid and there's no need to re-solve it.
+	struct LineResult {
+		LineSolver::Line input;
+		LineSolver::Line output;
+		bool consistent;
+	};
+
+	// The results of the last few different inputs of a line, most
+	// recently used first. propagate() starts from an empty table each
+	// time, and a line goes through the same inputs as in the previous
+	// call unless something changed around it; those are all kept, so
+	// the lines an edit didn't reach needn't be solved at all.
+	struct LineState {
+		std::vector<LineResult> results;
+	};
+
+	static const std::size_t historyLength = 8;
+
+	Nonogram::Constraints constraints;
+	std::vector<LineState> rowStates;
+	std::vector<LineState> colStates;
+
+	LineSolver solver;
+	LineSolver::Line scratch;
+
+	// The result of solving a line that currently looks like 'current'.
+	// Lines that aren't cached here are looked up in LineCache::shared().
+	const LineResult &update(LineState &state, const std::vector<int> &clues, const LineSolver::Line &current);
+
+public:
+	HintEngine(const Nonogram::Constraints &c);
+
+	inline const Nonogram::Constraints &getConstraints() const { return constraints; }
+
+	// Replace the clues of a single line. Only the cached
+	// state of that line is thrown away; the rest is kept.
+	void setRowClues(std::size_t i, const std::vector<int> &clues);
+	void setColClues(std::size_t j, const std::vector<int> &clues);
+
+	// 'table' must have the dimensions of the constraints; it may
+	// contain CELL_UNKNOWN entries. Rows are examined before columns.
+	Hint nextHint(const Nonogram::Table &table);
+
+	// Fills in every cell of 'table' that line logic can deduce,
+	// re-solving lines until none of them changes anymore.
+	// Returns false if some line turned out to be unsatisfiable.
+	bool propagate(Nonogram::Table &table);
+};
+
+#endif // NONOGRAM_HINTENGINE_HPP
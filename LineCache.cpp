@@ -0,0 +1,198 @@
+//
+// LineCache.cpp
+// Memoized line solving, keyed by clues and partial line state
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include "LineCache.hpp"
+
+#include <chrono>
+#include <algorithm>
+
+
+// Definitions of the constants, in case they're bound to references
+const std::size_t LineCache::maxLength;
+const std::size_t LineCache::maxClues;
+const std::size_t LineCache::words;
+const std::size_t LineCache::probeLength;
+const std::size_t LineCache::shardCount;
+
+// 64-bit finalizer of MurmurHash3
+static std::uint64_t mix(std::uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+LineCache::LineCache(std::size_t capacity) :
+	shards(new Shard[shardCount]),
+	slotsPerShard(std::max(probeLength, capacity / shardCount)),
+	hits(0),
+	misses(0),
+	uncacheable(0),
+	evictions(0),
+	missNanoseconds(0),
+	hitNanoseconds(0)
+{
+	for (std::size_t i = 0; i < shardCount; i++) {
+		shards[i].slots.assign(slotsPerShard, Slot());
+		shards[i].hand = 0;
+	}
+}
+
+LineCache &LineCache::shared() {
+	// 32k slots, about 4.5 MiB
+	static LineCache cache(1 << 15);
+	return cache;
+}
+
+// 2 bits per cell: 0 = unknown, 1 = white, 2 = black
+void LineCache::pack(const LineSolver::Line &line, std::uint64_t *out) {
+	std::fill(out, out + words, 0);
+
+	for (std::size_t i = 0; i < line.size(); i++) {
+		std::uint64_t code = line[i] == Nonogram::CELL_UNKNOWN ? 0 : line[i] == Nonogram::CELL_WHITE ? 1 : 2;
+		out[i / 32] |= code << (2 * (i % 32));
+	}
+}
+
+void LineCache::unpack(const std::uint64_t *in, LineSolver::Line &line) {
+	static const Nonogram::Cell cells[] = { Nonogram::CELL_UNKNOWN, Nonogram::CELL_WHITE, Nonogram::CELL_BLACK };
+
+	for (std::size_t i = 0; i < line.size(); i++) {
+		line[i] = cells[(in[i / 32] >> (2 * (i % 32))) & 3];
+	}
+}
+
+bool LineCache::solve(LineSolver &solver, const std::vector<int> &clues, LineSolver::Line &line) {
+	typedef std::chrono::steady_clock Clock;
+
+	// Clues that don't fit a slot can't describe a line this short
+	// anyway, but the solver is the one to say so
+	bool fits = line.size() <= maxLength and clues.size() <= maxClues and std::all_of(
+		clues.begin(), clues.end(), [](int clue) { return clue >= 0 and clue <= 255; }
+	);
+
+	if (not fits) {
+		uncacheable++;
+		return solver.solve(clues, line);
+	}
+
+	auto start = Clock::now();
+	auto nanosecondsSinceStart = [&] {
+		return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+	};
+
+	std::uint64_t key[words];
+	pack(line, key);
+
+	std::uint64_t hash = mix(clues.size() * 0x9e3779b97f4a7c15ULL + line.size());
+	for (int clue : clues) {
+		hash = mix(hash ^ std::uint64_t(clue));
+	}
+
+	for (std::size_t w = 0; w < words; w++) {
+		hash = mix(hash ^ key[w]);
+	}
+
+	Shard &shard = shards[hash % shardCount];
+	std::size_t home = (hash / shardCount) % slotsPerShard;
+
+	auto matches = [&](const Slot &slot) {
+		return slot.used
+		   and slot.hash == hash
+		   and slot.length == line.size()
+		   and slot.clueCount == clues.size()
+		   and std::equal(clues.begin(), clues.end(), slot.clues)
+		   and std::equal(key, key + words, slot.input);
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		for (std::size_t p = 0; p < probeLength; p++) {
+			Slot &slot = shard.slots[(home + p) % slotsPerShard];
+
+			if (matches(slot)) {
+				slot.referenced = true;
+				unpack(slot.output, line);
+				bool consistent = slot.consistent;
+
+				hits++;
+				hitNanoseconds += nanosecondsSinceStart();
+				return consistent;
+			}
+		}
+	}
+
+	// Solve without holding the lock; the solver is the caller's
+	bool consistent = solver.solve(clues, line);
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	// Take a free slot in the probe window if there's one; otherwise
+	// sweep the window with the clock hand, clearing reference bits,
+	// until a slot that hasn't been used since the last sweep turns up.
+	Slot *victim = nullptr;
+
+	for (std::size_t p = 0; p < probeLength and not victim; p++) {
+		Slot &slot = shard.slots[(home + p) % slotsPerShard];
+
+		if (not slot.used or matches(slot)) {
+			victim = &slot;
+		}
+	}
+
+	while (not victim) {
+		Slot &slot = shard.slots[(home + shard.hand) % slotsPerShard];
+		shard.hand = (shard.hand + 1) % probeLength;
+
+		if (slot.referenced) {
+			slot.referenced = false;
+		} else {
+			victim = &slot;
+			evictions++;
+		}
+	}
+
+	victim->hash = hash;
+	victim->length = std::uint16_t(line.size());
+	victim->clueCount = std::uint8_t(clues.size());
+	std::copy(clues.begin(), clues.end(), victim->clues);
+	victim->used = true;
+	victim->referenced = false;
+	victim->consistent = consistent;
+	std::copy(key, key + words, victim->input);
+	pack(line, victim->output);
+
+	misses++;
+	missNanoseconds += nanosecondsSinceStart();
+
+	return consistent;
+}
+
+LineCache::Statistics LineCache::statistics() const {
+	return {
+		hits,
+		misses,
+		uncacheable,
+		evictions,
+		missNanoseconds / 1e9,
+		hitNanoseconds / 1e9
+	};
+}
+
+void LineCache::resetStatistics() {
+	hits = 0;
+	misses = 0;
+	uncacheable = 0;
+	evictions = 0;
+	missNanoseconds = 0;
+	hitNanoseconds = 0;
+}
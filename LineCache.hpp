@@ -0,0 +1,107 @@
+//
+// LineCache.hpp
+// Memoized line solving, keyed by clues and partial line state
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#ifndef NONOGRAM_LINECACHE_HPP
+#define NONOGRAM_LINECACHE_HPP
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+#include "Nonogram.hpp"
+#include "LineSolver.hpp"
+
+// The same (clues, partially known line) pair is line-solved over and
+// over again: by the hint engine, by the validator after each edit, by
+// the classifier, across puzzles... This cache remembers the outcome.
+//
+// It uses a fixed amount of memory: a fixed number of slots, each of
+// which holds a line of at most maxLength cells, 2 bits per cell, along
+// with its clues and the deduced line. Longer lines are simply not
+// cached (and a line that short can't have more than maxClues). The slots
+// are split into independently locked shards, so concurrent users
+// rarely contend. A key can live in any slot of a small probe window;
+// when the window is full, a victim is chosen CLOCK-style (a slot that
+// was used since the hand last passed gets a second chance).
+class LineCache {
+public:
+	static const std::size_t maxLength = 128;
+	static const std::size_t maxClues = maxLength / 2;
+
+	struct Statistics {
+		std::size_t hits;
+		std::size_t misses;
+		std::size_t uncacheable; // lines longer than maxLength, or their clues too many
+		std::size_t evictions;
+		double missSeconds;      // time spent line-solving on misses
+		double hitSeconds;       // time spent answering hits
+
+		// What the hits would have cost without the cache
+		// (at the average price of a miss), minus what they did
+		double savedSeconds() const {
+			return misses ? hits * (missSeconds / misses) - hitSeconds : 0;
+		}
+	};
+
+protected:
+	static const std::size_t words = maxLength * 2 / 64;
+	static const std::size_t probeLength = 8;
+	static const std::size_t shardCount = 64;
+
+	struct Slot {
+		std::uint64_t hash;
+		std::uint16_t length;
+		bool used;
+		bool referenced; // CLOCK bit
+		bool consistent;
+		std::uint8_t clueCount;
+		std::uint8_t clues[maxClues];
+		std::uint64_t input[words];
+		std::uint64_t output[words];
+	};
+
+	struct Shard {
+		std::mutex mutex;
+		std::vector<Slot> slots;
+		std::size_t hand;
+	};
+
+	std::unique_ptr<Shard[]> shards;
+	std::size_t slotsPerShard;
+
+	std::atomic<std::size_t> hits;
+	std::atomic<std::size_t> misses;
+	std::atomic<std::size_t> uncacheable;
+	std::atomic<std::size_t> evictions;
+	std::atomic<std::uint64_t> missNanoseconds;
+	std::atomic<std::uint64_t> hitNanoseconds;
+
+	static void pack(const LineSolver::Line &line, std::uint64_t *out);
+	static void unpack(const std::uint64_t *in, LineSolver::Line &line);
+
+public:
+	// 'capacity' is the total number of slots (under 150 bytes each)
+	LineCache(std::size_t capacity);
+
+	LineCache(const LineCache &) = delete;
+	LineCache &operator=(const LineCache &) = delete;
+
+	// The cache shared by the hint engine, validator and classifier
+	static LineCache &shared();
+
+	// LineSolver::solve(), memoized
+	bool solve(LineSolver &solver, const std::vector<int> &clues, LineSolver::Line &line);
+
+	Statistics statistics() const;
+	void resetStatistics();
+};
+
+#endif // NONOGRAM_LINECACHE_HPP
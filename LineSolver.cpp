@@ -0,0 +1,173 @@
+//
+// LineSolver.cpp
+// Native single-line deduction (no Gecode model involved)
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include "LineSolver.hpp"
+
+#include <algorithm>
+
+
+bool LineSolver::solve(const std::vector<int> &clues, Line &line) {
+	std::size_t n = line.size();
+	std::size_t k = clues.size();
+	std::size_t w = k + 1; // row stride of 'fwd' and 'bwd'
+
+	fwd.assign((n + 1) * w, 0);
+	bwd.assign((n + 1) * w, 0);
+	whites.assign(n + 1, 0);
+	blackable.assign(n + 1, 0);
+	whiteable.assign(n, 0);
+
+	for (std::size_t i = 0; i < n; i++) {
+		whites[i + 1] = whites[i] + (line[i] == Nonogram::CELL_WHITE);
+	}
+
+	// true if none of the cells [p, p + s) is known to be white
+	auto fitsBlock = [&](std::size_t p, std::size_t s) {
+		return whites[p + s] == whites[p];
+	};
+
+	// Left to right: which prefixes can hold how many blocks?
+	// A prefix of i cells holds b blocks if either its last cell is white
+	// and the shorter prefix holds b blocks, or it ends with block #b-1
+	// which is preceded by a white separator (or the start of the line).
+	fwd[0] = 1;
+	for (std::size_t i = 1; i <= n; i++) {
+		for (std::size_t b = 0; b <= k; b++) {
+			bool ok = line[i - 1] != Nonogram::CELL_BLACK and fwd[(i - 1) * w + b];
+
+			if (not ok and b > 0) {
+				std::size_t s = clues[b - 1];
+
+				if (i >= s and fitsBlock(i - s, s)) {
+					std::size_t p = i - s;
+
+					if (p == 0) {
+						ok = b == 1;
+					} else {
+						ok = line[p - 1] != Nonogram::CELL_BLACK and fwd[(p - 1) * w + b - 1];
+					}
+				}
+			}
+
+			fwd[i * w + b] = ok;
+		}
+	}
+
+	if (not fwd[n * w + k]) {
+		return false;
+	}
+
+	// Right to left, symmetrically: can the suffix starting
+	// at cell i hold the blocks b, b + 1, ..., k - 1?
+	bwd[n * w + k] = 1;
+	for (std::size_t i = n; i-- > 0;) {
+		for (std::size_t b = k + 1; b-- > 0;) {
+			bool ok = line[i] != Nonogram::CELL_BLACK and bwd[(i + 1) * w + b];
+
+			if (not ok and b < k) {
+				std::size_t s = clues[b];
+				std::size_t e = i + s;
+
+				if (e <= n and fitsBlock(i, s)) {
+					if (e == n) {
+						ok = b == k - 1;
+					} else {
+						ok = line[e] != Nonogram::CELL_BLACK and bwd[(e + 1) * w + b + 1];
+					}
+				}
+			}
+
+			bwd[i * w + b] = ok;
+		}
+	}
+
+	// A cell can be white if the blocks can be split around it
+	for (std::size_t i = 0; i < n; i++) {
+		if (line[i] == Nonogram::CELL_BLACK) {
+			continue;
+		}
+
+		for (std::size_t b = 0; b <= k; b++) {
+			if (fwd[i * w + b] and bwd[(i + 1) * w + b]) {
+				whiteable[i] = 1;
+				break;
+			}
+		}
+	}
+
+	// A cell can be black if some block can be placed over it
+	for (std::size_t b = 0; b < k; b++) {
+		std::size_t s = clues[b];
+
+		for (std::size_t p = 0; p + s <= n; p++) {
+			if (not fitsBlock(p, s)) {
+				continue;
+			}
+
+			bool left = p == 0 ? b == 0 : line[p - 1] != Nonogram::CELL_BLACK and fwd[(p - 1) * w + b];
+			if (not left) {
+				continue;
+			}
+
+			bool right = p + s == n ? b == k - 1 : line[p + s] != Nonogram::CELL_BLACK and bwd[(p + s + 1) * w + b + 1];
+			if (not right) {
+				continue;
+			}
+
+			blackable[p]++;
+			blackable[p + s]--;
+		}
+	}
+
+	int coverage = 0;
+	for (std::size_t i = 0; i < n; i++) {
+		coverage += blackable[i];
+
+		if (line[i] != Nonogram::CELL_UNKNOWN) {
+			continue;
+		}
+
+		if (coverage > 0 and not whiteable[i]) {
+			line[i] = Nonogram::CELL_BLACK;
+		} else if (coverage == 0 and whiteable[i]) {
+			line[i] = Nonogram::CELL_WHITE;
+		}
+	}
+
+	return true;
+}
+
+std::size_t LineSolver::countPlacements(const std::vector<int> &clues, std::size_t length, std::size_t cap) {
+	std::size_t k = clues.size();
+	std::size_t minLength = k ? k - 1 : 0; // separators
+
+	for (int clue : clues) {
+		minLength += clue;
+	}
+
+	if (minLength > length) {
+		return 0;
+	}
+
+	// The white cells that aren't mandatory separators can be
+	// distributed among the k + 1 gaps in BINOM(free + k, k) ways.
+	// Products of integers are exact in a double well beyond any
+	// cap we'd use, so this is exact as long as it's below 'cap'.
+	std::size_t free = length - minLength;
+	double count = 1;
+
+	for (std::size_t i = 1; i <= k; i++) {
+		count = count * (free + i) / i;
+
+		if (count >= cap) {
+			return cap;
+		}
+	}
+
+	return std::min(cap, std::size_t(count + 0.5));
+}
@@ -0,0 +1,51 @@
+//
+// LineSolver.hpp
+// Native single-line deduction (no Gecode model involved)
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#ifndef NONOGRAM_LINESOLVER_HPP
+#define NONOGRAM_LINESOLVER_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "Nonogram.hpp"
+
+// A LineSolver deduces every cell of a single, partially known line
+// (row or column) that is forced by the clues of that line alone.
+// It is a plain dynamic programming algorithm, O(length * #blocks),
+// so it is cheap enough to be run interactively. The scratch buffers
+// are kept between calls, so a long-lived instance does not allocate
+// once it has seen the longest line.
+class LineSolver {
+public:
+	typedef std::vector<Nonogram::Cell> Line;
+
+protected:
+	// fwd[i * (k + 1) + b]: the first i cells can hold the first b blocks
+	// bwd[i * (k + 1) + b]: the cells from i onwards can hold blocks b...k-1
+	std::vector<unsigned char> fwd;
+	std::vector<unsigned char> bwd;
+
+	// whites[i]: number of known white cells among the first i cells
+	std::vector<int> whites;
+
+	// Difference array of the cells that can be black in some placement
+	std::vector<int> blackable;
+	std::vector<unsigned char> whiteable;
+
+public:
+	// Fills in each CELL_UNKNOWN of 'line' that has the same value
+	// in every placement of 'clues' consistent with the known cells.
+	// Returns false (and leaves 'line' alone) if there's no such placement.
+	bool solve(const std::vector<int> &clues, Line &line);
+
+	// The number of ways 'clues' can be placed in an empty line of
+	// 'length' cells, saturating at 'cap' (the count grows very fast).
+	static std::size_t countPlacements(const std::vector<int> &clues, std::size_t length, std::size_t cap);
+};
+
+#endif // NONOGRAM_LINESOLVER_HPP
@@ -9,11 +9,23 @@
 //
 
 #include "Nonogram.hpp"
+#include "DfaCache.hpp"
+#include "Verifier.hpp"
+#include "LineSolver.hpp"
+#include "Trace.hpp"
+
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <thread>
 
 std::mutex Nonogram::steps_mutex;
 std::unordered_map<void *, std::vector<Nonogram::Table> *> Nonogram::steps;
 
 Gecode::REG Nonogram::buildRegexForLine(std::vector<int> blockSizes) {
+	NONOGRAM_TRACE_SCOPE("buildRegexForLine");
+
 	Gecode::REG regex;
 
 	// It's trivial to convert a block size description into
@@ -44,7 +56,60 @@ Gecode::REG Nonogram::buildRegexForLine(std::vector<int> blockSizes) {
 	return regex;
 }
 
+Gecode::TupleSet Nonogram::buildTupleSetForLine(const std::vector<int> &blockSizes, std::size_t length) {
+	NONOGRAM_TRACE_SCOPE("buildTupleSetForLine");
+
+	Gecode::TupleSet tuples;
+	Gecode::IntArgs cells(static_cast<int>(length));
+	std::size_t k = blockSizes.size();
+
+	// needed[b]: the minimal number of cells taken by blocks b...k-1
+	std::vector<std::size_t> needed(k + 1, 0);
+	for (std::size_t b = k; b-- > 0;) {
+		needed[b] = blockSizes[b] + needed[b + 1] + (b + 1 < k);
+	}
+
+	// Places block #b at each possible position from cell 'from' on;
+	// the cells before 'from' are already filled in
+	std::function<void(std::size_t, std::size_t)> place = [&](std::size_t b, std::size_t from) {
+		if (b == k) {
+			for (std::size_t i = from; i < length; i++) {
+				cells[int(i)] = CELL_WHITE;
+			}
+
+			tuples.add(cells);
+			return;
+		}
+
+		std::size_t size = blockSizes[b];
+
+		for (std::size_t start = from; start + needed[b] <= length; start++) {
+			for (std::size_t i = from; i < start; i++) {
+				cells[int(i)] = CELL_WHITE;
+			}
+
+			for (std::size_t i = start; i < start + size; i++) {
+				cells[int(i)] = CELL_BLACK;
+			}
+
+			if (b + 1 < k) {
+				cells[int(start + size)] = CELL_WHITE;
+				place(b + 1, start + size + 1);
+			} else {
+				place(b + 1, start + size);
+			}
+		}
+	};
+
+	place(0, 0);
+	tuples.finalize();
+
+	return tuples;
+}
+
 Nonogram::Table Nonogram::getState() const {
+	NONOGRAM_TRACE_SCOPE("getState");
+
 	std::vector<std::vector<Nonogram::Cell>> table(
 		this->rows(),
 		std::vector<Nonogram::Cell>(this->cols())
@@ -60,84 +125,140 @@ Nonogram::Table Nonogram::getState() const {
 	return table;
 }
 
-Nonogram::Constraints Nonogram::constraintsFromTable(const Nonogram::Table &t) {
-	auto constraintGen = [=](const std::vector<Cell> &seq) {
-		std::vector<int> blockSizes;
-
-		std::size_t i = 0;
-		while (i < seq.size()) {
-			int consec = 0;
-			while (i < seq.size() and seq[i]) {
-				i++;
-				consec++;
-			}
+std::vector<int> Nonogram::blockSizesOfLine(const std::vector<Cell> &seq) {
+	std::vector<int> blockSizes;
 
-			if (i > 0) {
-				blockSizes.push_back(consec);
-			}
-
-			while (i < seq.size() and not seq[i]) {
-				i++;
-			}
+	std::size_t i = 0;
+	while (i < seq.size()) {
+		int consec = 0;
+		while (i < seq.size() and seq[i] != CELL_WHITE) {
+			i++;
+			consec++;
 		}
 
-		return blockSizes;
-	};
-
-
-	// for each row...
-	auto rowConstraints = _map(t, constraintGen);
-
-	// ...and column
-	std::vector<std::vector<int>> colConstraints;
-	for (std::size_t i = 0; i < (t.size() ? t[0].size() : 0); i++) {
-		auto ith_col = _map(t, [=](const std::vector<Cell> &row) {
-			return row[i];
-		});
+		if (i > 0) {
+			blockSizes.push_back(consec);
+		}
 
-		colConstraints.push_back(constraintGen(ith_col));
+		while (i < seq.size() and seq[i] == CELL_WHITE) {
+			i++;
+		}
 	}
 
-	return { rowConstraints, colConstraints };
+	return blockSizes;
+}
+
+Nonogram::Constraints Nonogram::constraintsFromTable(const Nonogram::Table &t) {
+	// Works on a bit-packed copy of the table, which is also
+	// transposed on the fly, so columns needn't be gathered
+	Verifier verifier;
+	return verifier.extractConstraints(t);
 }
 
-Nonogram::Nonogram(const Nonogram::Constraints &c) :
+Nonogram::Nonogram(const Nonogram::Constraints &c, const Nonogram::Strategy &strategy) :
 	constraints(c),
 	cellArray(
 		*this,
 		this->rows() * this->cols(),
 		0,
 		1
-	)
+	),
+	profile()
 {
+	NONOGRAM_TRACE_SCOPE("build model");
+
+	typedef std::chrono::steady_clock Clock;
+	typedef std::chrono::duration<double> Seconds;
+
 	// Add regular expression constraints to lines
 	// in both dimensions (rows and columns)
 	// In order to extract the rows and columns from
 	// our 2D array, we use a Matrix.
 	Gecode::Matrix<Gecode::BoolVarArray> helperMat(cellArray, this->cols(), this->rows());
 
+	// Lines with only a few placements get an explicit table of them;
+	// the rest get a DFA (identical clues share their compiled DFA).
+	auto postLine = [&](const std::vector<int> &clues, const Gecode::BoolVarArgs &line) {
+		std::size_t length = line.size();
+		std::size_t threshold = strategy.tupleSetThreshold;
+		auto start = Clock::now();
+
+		if (threshold and length and LineSolver::countPlacements(clues, length, threshold + 1) <= threshold) {
+			auto tuples = buildTupleSetForLine(clues, length);
+			auto built = Clock::now();
+			Gecode::extensional(*this, line, tuples);
+
+			profile.tupleSetSeconds += Seconds(built - start).count();
+			profile.postSeconds += Seconds(Clock::now() - built).count();
+			profile.tupleSetLines++;
+			profile.tupleSetCells += tuples.tuples() * length;
+			return;
+		}
+
+		bool hit;
+		auto dfa = DfaCache::get(clues, &hit);
+		auto compiled = Clock::now();
+		Gecode::extensional(*this, line, dfa);
+
+		profile.dfaSeconds += Seconds(compiled - start).count();
+		profile.postSeconds += Seconds(Clock::now() - compiled).count();
+		profile.dfaTransitions += dfa.n_transitions();
+		(hit ? profile.dfaHits : profile.dfaMisses)++;
+	};
+
 	// Rows
 	for (std::size_t i = 0; i < this->rows(); i++) {
-		auto regexForRow = buildRegexForLine(constraints.rows[i]);
-		Gecode::extensional(*this, helperMat.row(i), regexForRow);
+		postLine(constraints.rows[i], helperMat.row(i));
 	}
 
 	// Columns
 	for (std::size_t i = 0; i < this->cols(); i++) {
-		auto regexForCol = buildRegexForLine(constraints.cols[i]);
-		Gecode::extensional(*this, helperMat.col(i), regexForCol);
+		postLine(constraints.cols[i], helperMat.col(i));
 	}
 
-	// while performing Depth-First Search, select child nodes
-	// based on their Accumulated Failure Count (AFC)
-	branch(*this, cellArray, Gecode::INT_VAR_AFC_MAX(1.0), Gecode::INT_VAL_MAX());
+	auto start = Clock::now();
+
+	// By default, while performing Depth-First Search, select
+	// child nodes based on their Accumulated Failure Count (AFC)
+	Gecode::IntVarBranch varBranch;
+	switch (strategy.variableOrder) {
+	case VAR_AFC_MAX:      varBranch = Gecode::INT_VAR_AFC_MAX(1.0);                    break;
+	case VAR_ACTIVITY_MAX: varBranch = Gecode::INT_VAR_ACTIVITY_MAX(1.0);               break;
+	case VAR_DEGREE_MAX:   varBranch = Gecode::INT_VAR_DEGREE_MAX();                    break;
+	case VAR_ROW_MAJOR:    varBranch = Gecode::INT_VAR_NONE();                          break;
+	case VAR_RANDOM:       varBranch = Gecode::INT_VAR_RND(Gecode::Rnd(strategy.seed)); break;
+	}
+
+	// The value order is expressed as a preferred value for each cell,
+	// so that solve() can override it cell by cell with a hint. A random
+	// order is a random (but fixed and seeded) preference for each cell.
+	std::vector<Cell> values(this->rows() * this->cols());
+	std::mt19937 rng(strategy.seed + 1);
+
+	for (auto &value : values) {
+		switch (strategy.valueOrder) {
+		case VAL_MAX:    value = CELL_BLACK;                          break;
+		case VAL_MIN:    value = CELL_WHITE;                          break;
+		case VAL_RANDOM: value = rng() % 2 ? CELL_BLACK : CELL_WHITE; break;
+		}
+	}
+
+	preference = std::make_shared<const std::vector<Cell>>(std::move(values));
+
+	branch(*this, cellArray, varBranch, Gecode::INT_VAL(&Nonogram::preferredValue));
+
+	profile.branchSeconds = Seconds(Clock::now() - start).count();
 }
 
 Nonogram::Nonogram(bool isShared, Nonogram::Nonogram &that) :
 	Space(isShared, that),
 	constraints(that.constraints),
-	key(that.key)
+	key(that.key),
+	profile(),
+	preference(that.preference)
 {
+	NONOGRAM_TRACE_SCOPE("clone");
+
 	cellArray.update(*this, isShared, that.cellArray);
 
 	std::lock_guard<std::mutex> lock(steps_mutex);
@@ -147,42 +268,384 @@ Nonogram::Nonogram(bool isShared, Nonogram::Nonogram &that) :
 	}
 }
 
-std::vector<Nonogram::Table> Nonogram::solve(std::size_t nSolutions, std::vector<std::vector<Table>> *outSteps) {
+void Nonogram::exclude(const Table &solution) {
+	// The clause is satisfied if one of the cells that are white
+	// in 'solution' is black, or one of the black ones is white.
+	Gecode::BoolVarArgs whites, blacks;
+
+	for (std::size_t i = 0; i < this->rows(); i++) {
+		for (std::size_t j = 0; j < this->cols(); j++) {
+			const auto &var = cellArray[i * this->cols() + j];
+
+			if (solution[i][j] == CELL_BLACK) {
+				blacks << var;
+			} else {
+				whites << var;
+			}
+		}
+	}
+
+	Gecode::clause(*this, Gecode::BOT_OR, whites, blacks, 1);
+}
+
+void Nonogram::exclude(const Table &solution, const std::vector<std::size_t> &cells) {
+	Gecode::BoolVarArgs whites, blacks;
+
+	for (auto k : cells) {
+		const auto &var = cellArray[k];
+
+		if (solution[k / this->cols()][k % this->cols()] == CELL_BLACK) {
+			blacks << var;
+		} else {
+			whites << var;
+		}
+	}
+
+	Gecode::clause(*this, Gecode::BOT_OR, whites, blacks, 1);
+}
+
+int Nonogram::preferredValue(const Gecode::Space &home, Gecode::BoolVar, int i) {
+	return (*static_cast<const Nonogram &>(home).preference)[i];
+}
+
+void Nonogram::prefer(const Table &hint) {
+	auto values = std::make_shared<std::vector<Cell>>(*preference);
+
+	for (std::size_t i = 0; i < this->rows(); i++) {
+		for (std::size_t j = 0; j < this->cols(); j++) {
+			if (hint[i][j] != CELL_UNKNOWN) {
+				(*values)[i * this->cols() + j] = hint[i][j];
+			}
+		}
+	}
+
+	preference = values;
+}
+
+void Nonogram::assume(const Table &hint) {
+	for (std::size_t i = 0; i < this->rows(); i++) {
+		for (std::size_t j = 0; j < this->cols(); j++) {
+			if (hint[i][j] != CELL_UNKNOWN) {
+				Gecode::rel(*this, cellArray[i * this->cols() + j], Gecode::IRT_EQ, hint[i][j]);
+			}
+		}
+	}
+}
+
+void Nonogram::beginSolution(std::vector<std::vector<Table>> *outSteps) {
+	std::lock_guard<std::mutex> lock(steps_mutex);
+
+	if (outSteps) {
+		outSteps->push_back({});
+		steps[key] = &outSteps->back();
+	}
+}
+
+std::vector<Nonogram::Table> Nonogram::solve(std::size_t nSolutions, std::vector<std::vector<Table>> *outSteps, const SolveOptions &solveOptions) {
+	NONOGRAM_TRACE_SCOPE("solve");
+
 	key = outSteps;
 
-	// Create depth-first search solver engine
-	Gecode::DFS<Nonogram> solverEngine(this);
+	// A hint that doesn't fit the puzzle is ignored
+	const Table *hint = solveOptions.hint;
+	if (hint and (hint->size() != this->rows() or std::any_of(hint->begin(), hint->end(), [=](const std::vector<Cell> &row) {
+		return row.size() != this->cols();
+	}))) {
+		hint = nullptr;
+	}
+
+	// The hint only applies to this search, so
+	// the previous preference is restored afterwards
+	auto previousPreference = preference;
+	if (hint) {
+		prefer(*hint);
+	}
+
+#ifdef NONOGRAM_ENABLE_TRACING
+	// The engines would propagate the root anyway,
+	// but this way it shows up in the trace on its own
+	{
+		NONOGRAM_TRACE_SCOPE("root propagation");
+		this->status();
+	}
+#endif
 
 	// The results are accumulated in this array.
 	std::vector<Nonogram::Table> results;
+	bool stopped = false;
 
-	for (std::size_t i = 0; i < nSolutions; i++) {
-		{
-			std::lock_guard<std::mutex> lock(steps_mutex);
+	// The assumptions only make the search space smaller, so whatever
+	// is found under them is a solution of the original puzzle too.
+	// If they turn out to be wrong, the search fails quickly.
+	if (hint and solveOptions.assumeHint and this->status() != Gecode::SS_FAILED) {
+		std::size_t nSteps = outSteps ? outSteps->size() : 0;
+		std::unique_ptr<Nonogram> assumed(static_cast<Nonogram *>(this->clone()));
 
+		assumed->assume(*hint);
+		results = assumed->search(nSolutions, outSteps, solveOptions, stopped);
+
+		if (results.size() < nSolutions and not stopped) {
 			if (outSteps) {
-				outSteps->push_back({});
-				steps[key] = &outSteps->back();
+				// The fallback search clones this space before it
+				// starts a new solution, so the steps of the abandoned
+				// one mustn't be pointed to while they're destroyed
+				std::lock_guard<std::mutex> lock(steps_mutex);
+				steps[key] = nullptr;
+				outSteps->resize(nSteps);
 			}
-		}
-
-		// The pointer returned by DFS::next() is owning; it needs to be delete'd.
-		// We do this more safely using a smart pointer.
-		auto solution = std::unique_ptr<Nonogram>(solverEngine.next());
 
-		// DFS::next() returns nullptr when there are no more solutions
-		if (solution) {
-			results.push_back(solution->getState());
-		} else {
-			break;
+			results = search(nSolutions, outSteps, solveOptions, stopped);
 		}
-
+	} else {
+		results = search(nSolutions, outSteps, solveOptions, stopped);
 	}
 
+	preference = previousPreference;
+
 	// Clean up after ourselves: if we left the potentially invalidated
 	// pointer to the elements of the outSteps vector, we would have a
 	// dangling pointer, and next time we would try to access the
 	// -- erroneously non-null -- pointer, the solver could crash...
+	std::lock_guard<std::mutex> lock(steps_mutex);
 	steps[key] = nullptr;
 	return results;
 }
+
+std::vector<Nonogram::Table> Nonogram::search(
+	std::size_t nSolutions,
+	std::vector<std::vector<Table>> *outSteps,
+	const SolveOptions &solveOptions,
+	bool &stopped
+)
+{
+	Gecode::Search::Options options;
+	options.stop = solveOptions.stop;
+
+	std::vector<Nonogram::Table> results;
+	stopped = false;
+
+	if (solveOptions.engine == SEARCH_DFS) {
+		// Create depth-first search solver engine
+		Gecode::DFS<Nonogram> solverEngine(this, options);
+
+		for (std::size_t i = 0; i < nSolutions; i++) {
+			beginSolution(outSteps);
+
+			// The pointer returned by DFS::next() is owning; it needs to be delete'd.
+			// We do this more safely using a smart pointer.
+			std::unique_ptr<Nonogram> solution;
+			{
+				NONOGRAM_TRACE_SCOPE("DFS::next");
+				solution.reset(solverEngine.next());
+			}
+
+			// DFS::next() returns nullptr when there are no more solutions
+			if (solution) {
+				results.push_back(solution->getState());
+			} else {
+				stopped = solverEngine.stopped();
+				break;
+			}
+		}
+	} else if (this->status() != Gecode::SS_FAILED) {
+		// Restart-based search may well find the same solution again
+		// after a restart, so we only ask each engine for one solution,
+		// then rule it out in our own copy of the model and start over.
+		// The nogoods are kept across the restarts of one engine.
+		std::unique_ptr<Nonogram> root(static_cast<Nonogram *>(this->clone()));
+
+		options.nogoods_limit = solveOptions.nogoodsLimit;
+
+		for (std::size_t i = 0; i < nSolutions; i++) {
+			beginSolution(outSteps);
+
+			// The engine takes ownership of the cutoff object
+			options.cutoff = Gecode::Search::Cutoff::luby(solveOptions.restartScale);
+			Gecode::RBS<Gecode::DFS, Nonogram> solverEngine(root.get(), options);
+			std::unique_ptr<Nonogram> solution;
+			{
+				NONOGRAM_TRACE_SCOPE("RBS::next");
+				solution.reset(solverEngine.next());
+			}
+
+			if (not solution) {
+				stopped = solverEngine.stopped();
+				break;
+			}
+
+			results.push_back(solution->getState());
+			root->exclude(results.back());
+
+			if (root->status() == Gecode::SS_FAILED) {
+				break;
+			}
+		}
+	}
+
+	return results;
+}
+
+Nonogram::Table Nonogram::backbone(unsigned int threads, Gecode::Search::Stop *stop) {
+	NONOGRAM_TRACE_SCOPE("backbone");
+
+	// Find a solution first; only its values can be forced. Then keep
+	// asking "is there a solution in which at least one of these cells
+	// differs?" for a batch of the remaining candidate cells. A new
+	// solution usually differs in many cells, which are all free then;
+	// if there's none, every cell of the batch is forced. The workers
+	// check disjoint batches at the same time, each in its own copy of
+	// the model, which is kept (and strengthened with the cells proven
+	// forced so far) for all the batches that worker checks.
+	SolveOptions options;
+	options.stop = stop;
+
+	key = nullptr;
+
+	if (this->status() == Gecode::SS_FAILED) {
+		return {};
+	}
+
+	bool firstStopped;
+	auto first = search(1, nullptr, options, firstStopped);
+	if (first.empty()) {
+		return {};
+	}
+
+	const Table &solution = first[0];
+	std::size_t rows = this->rows();
+	std::size_t cols = this->cols();
+
+	enum CellState : unsigned char {
+		CANDIDATE, // might be forced
+		CHECKING,  // in the batch of a worker
+		FORCED,
+		FREE
+	};
+
+	std::vector<CellState> states(rows * cols, CANDIDATE);
+	std::size_t nCandidates = rows * cols;
+	bool gaveUp = false;
+	std::mutex mutex;
+
+	// Each worker steers its search away from the first solution
+	Table opposite = solution;
+	for (auto &row : opposite) {
+		for (auto &cell : row) {
+			cell = cell == CELL_BLACK ? CELL_WHITE : CELL_BLACK;
+		}
+	}
+
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	auto work = [&] {
+		std::unique_ptr<Nonogram> root;
+		std::vector<bool> fixed(rows * cols, false);
+		std::vector<std::size_t> batch;
+
+		{
+			// Not shared, so that it can be searched on another thread
+			std::lock_guard<std::mutex> lock(mutex);
+			root.reset(static_cast<Nonogram *>(this->clone(false)));
+		}
+
+		root->prefer(opposite);
+
+		while (true) {
+			batch.clear();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (gaveUp or nCandidates == 0) {
+					break;
+				}
+
+				// An equal share of what's left, so the workers stay busy
+				std::size_t size = (nCandidates + threads - 1) / threads;
+
+				for (std::size_t k = 0; k < states.size(); k++) {
+					if (states[k] == FORCED and not fixed[k]) {
+						Gecode::rel(*root, root->cellArray[k], Gecode::IRT_EQ, solution[k / cols][k % cols]);
+						fixed[k] = true;
+					} else if (states[k] == CANDIDATE and batch.size() < size) {
+						states[k] = CHECKING;
+						batch.push_back(k);
+						nCandidates--;
+					}
+				}
+			}
+
+			std::unique_ptr<Nonogram> query;
+			Table other;
+
+			if (root->status() != Gecode::SS_FAILED) {
+				NONOGRAM_TRACE_SCOPE("backbone query");
+
+				query.reset(static_cast<Nonogram *>(root->clone()));
+				query->exclude(solution, batch);
+
+				bool stopped;
+				auto found = query->search(1, nullptr, options, stopped);
+				if (found.size()) {
+					other = found[0];
+				} else if (stopped) {
+					// Give up; whatever is unchecked counts as free
+					std::lock_guard<std::mutex> lock(mutex);
+					gaveUp = true;
+					break;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (other.empty()) {
+				for (auto k : batch) {
+					states[k] = FORCED;
+				}
+				continue;
+			}
+
+			// Every cell where the other solution differs is free,
+			// not only those in the batch; the rest of the batch
+			// goes back among the candidates
+			for (std::size_t k = 0; k < states.size(); k++) {
+				std::size_t i = k / cols;
+				std::size_t j = k % cols;
+
+				if (other[i][j] != solution[i][j]) {
+					if (states[k] == CANDIDATE) {
+						nCandidates--;
+					}
+					states[k] = FREE;
+				}
+			}
+
+			for (auto k : batch) {
+				if (states[k] == CHECKING) {
+					states[k] = CANDIDATE;
+					nCandidates++;
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int t = 0; t < threads; t++) {
+		workers.emplace_back(work);
+	}
+
+	for (auto &worker : workers) {
+		worker.join();
+	}
+
+	Table result(rows, std::vector<Cell>(cols, CELL_UNKNOWN));
+	for (std::size_t k = 0; k < states.size(); k++) {
+		if (states[k] == FORCED) {
+			result[k / cols][k % cols] = solution[k / cols][k % cols];
+		}
+	}
+
+	return result;
+}
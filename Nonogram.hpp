@@ -39,6 +39,99 @@ public:
 	// This is what we use to describe and return a particular solution
 	typedef std::vector<std::vector<Cell>> Table;
 
+	// Which unassigned cell to branch on next
+	enum VariableOrder {
+		VAR_AFC_MAX,      // highest accumulated failure count
+		VAR_ACTIVITY_MAX, // highest activity
+		VAR_DEGREE_MAX,   // most propagators attached
+		VAR_ROW_MAJOR,    // simply the first one
+		VAR_RANDOM
+	};
+
+	// Which value to try first for that cell
+	enum ValueOrder {
+		VAL_MAX, // black first
+		VAL_MIN, // white first
+		VAL_RANDOM
+	};
+
+	// How the model is built and how the search branches.
+	// Random orders are seeded with 'seed', so they are reproducible.
+	struct Strategy {
+		VariableOrder variableOrder;
+		ValueOrder valueOrder;
+		unsigned int seed;
+
+		// Lines with at most this many possible placements are posted
+		// as an explicit table of the placements (a TupleSet) instead
+		// of a DFA; 0 (the default) means always using DFAs. Tables
+		// propagate faster on tight lines, but their size explodes on
+		// ambiguous ones; measure with 'benchmark hybrid' before use.
+		std::size_t tupleSetThreshold;
+
+		Strategy() :
+			variableOrder(VAR_AFC_MAX),
+			valueOrder(VAL_MAX),
+			seed(0),
+			tupleSetThreshold(0)
+		{}
+	};
+
+	enum SearchEngine {
+		SEARCH_DFS,    // plain depth-first search
+		SEARCH_RESTART // restart-based DFS, keeping nogoods across restarts
+	};
+
+	// Optional knobs of solve(). The defaults reproduce plain DFS.
+	struct SolveOptions {
+		// If non-null and it tells the search to stop,
+		// solve() returns the solutions found so far.
+		Gecode::Search::Stop *stop;
+
+		SearchEngine engine;
+
+		// SEARCH_RESTART only: the failure limit of the n-th restart
+		// is restartScale * luby(n), and nogoods are extracted from
+		// the top nogoodsLimit levels of the abandoned search tree.
+		unsigned long restartScale;
+		unsigned int nogoodsLimit;
+
+		// If non-null, a table with the dimensions of the puzzle, e. g.
+		// the solution before the clues were edited, or a partially
+		// filled in table. When branching on a cell that is known in
+		// the hint, the hinted value is tried first.
+		const Table *hint;
+
+		// Also assume the known cells of 'hint' to be right: search with
+		// them fixed first, and only if that finds fewer than nSolutions
+		// solutions, search the whole space. Worth it when nSolutions is
+		// 1, or when the hint is partial, but not for uniqueness checks.
+		bool assumeHint;
+
+		SolveOptions() :
+			stop(nullptr),
+			engine(SEARCH_DFS),
+			restartScale(100),
+			nogoodsLimit(128),
+			hint(nullptr),
+			assumeHint(false)
+		{}
+	};
+
+	// Where the time went while building the model (in seconds),
+	// and how many of the line DFAs were found in the DfaCache
+	struct ConstructionProfile {
+		double dfaSeconds;      // looking up or compiling DFAs
+		double tupleSetSeconds; // counting placements, building TupleSets
+		double postSeconds;     // posting the extensional constraints
+		double branchSeconds;   // posting the branching
+		std::size_t dfaHits;
+		std::size_t dfaMisses;
+		std::size_t tupleSetLines;  // lines posted as a TupleSet
+		std::size_t tupleSetCells;  // total size of those TupleSets (tuples * arity)
+		std::size_t dfaTransitions; // total size of the DFAs of the other lines
+	};
+
 protected:
 	// steps is a lookup table from a pointer as key to a vector of
 	// nonogram configurations. The vector of nonogram configurations
@@ -58,7 +151,15 @@ protected:
 
 	void *key;
 
-	static Gecode::REG buildRegexForLine(std::vector<int> blockSizes);
+	// Only filled in by the user-friendly constructor, not by clones
+	ConstructionProfile profile;
+
+	// The value to try first when branching on each cell (row major).
+	// It's shared by all clones, so it's replaced, never modified.
+	std::shared_ptr<const std::vector<Cell>> preference;
+
+	// The value selection function of the branching
+	static int preferredValue(const Gecode::Space &home, Gecode::BoolVar x, int i);
 
 	// This returns the state of each cell (i. e. the solution
 	// itself) in row major format, so that it's easier to print.
@@ -66,16 +167,53 @@ protected:
 	// 0 = white, 1 = black, -1 = unknown).
 	Table getState() const;
 
+	// Rules out 'solution' (that is, at least one cell must differ)
+	void exclude(const Table &solution);
+
+	// Weaker: at least one of 'cells' (row major indices) must differ
+	void exclude(const Table &solution, const std::vector<std::size_t> &cells);
+
+	// Records the steps of the search towards the next solution
+	void beginSolution(std::vector<std::vector<Table>> *outSteps);
+
+	// Try the known cells of 'hint' first when branching
+	void prefer(const Table &hint);
+
+	// Fix the known cells of 'hint'
+	void assume(const Table &hint);
+
+	// The search proper, starting from this space. Sets 'stopped'
+	// if the search was cut short by the stop object of 'options'.
+	std::vector<Table> search(
+		std::size_t nSolutions,
+		std::vector<std::vector<Table>> *outSteps,
+		const SolveOptions &options,
+		bool &stopped
+	);
+
 public:
 
+	// Regular expression matching the lines described by 'blockSizes'.
+	// Compiling it is costly; prefer DfaCache::get() to calling this.
+	static Gecode::REG buildRegexForLine(std::vector<int> blockSizes);
+
+	// Every placement of 'blockSizes' in a line of 'length' cells
+	static Gecode::TupleSet buildTupleSetForLine(const std::vector<int> &blockSizes, std::size_t length);
+
 	// Convert table configuration into its matching constraint set
 	static Constraints constraintsFromTable(const Table &t);
 
+	// The sizes of the black blocks in a single row or column.
+	// Every cell that isn't CELL_WHITE counts as black.
+	static std::vector<int> blockSizesOfLine(const std::vector<Cell> &seq);
+
 	inline std::size_t rows() const { return constraints.rows.size(); }
 	inline std::size_t cols() const { return constraints.cols.size(); }
 
+	inline const ConstructionProfile &constructionProfile() const { return profile; }
+
 	// User-friendly constructor
-	Nonogram(const Constraints &c);
+	Nonogram(const Constraints &c, const Strategy &strategy = Strategy());
 
 	// Required, machine-friendly constructor
 	Nonogram(bool isShared, Nonogram &that);
@@ -89,7 +227,22 @@ public:
 	// 'steps' is either nullptr, or it should point to a vector of
 	//  vector of tables. It will be filled with the state of the
 	//  table for each heuristic branching step for each solution.
-	std::vector<Table> solve(std::size_t nSolutions = 1, std::vector<std::vector<Table>> *outSteps = nullptr);
+	// 'options' selects the search engine, and whether/when to stop.
+	std::vector<Table> solve(
+		std::size_t nSolutions = 1,
+		std::vector<std::vector<Table>> *outSteps = nullptr,
+		const SolveOptions &options = SolveOptions()
+	);
+
+	// The backbone of the puzzle, without enumerating its solutions:
+	// cells that have the same value in every solution are CELL_BLACK
+	// or CELL_WHITE, the others (where the ambiguity is) CELL_UNKNOWN.
+	// Empty if there's no solution (or 'stop' fired before the first
+	// one was found). The cells are checked by 'threads' workers at once
+	// (0 means one per core). If 'stop' fires, the cells that haven't
+	// been proven forced yet are CELL_UNKNOWN; it is polled by every
+	// worker, so it must be thread-safe.
+	Table backbone(unsigned int threads = 0, Gecode::Search::Stop *stop = nullptr);
 };
 
 #endif // NONOGRAM_NONOGRAM_HPP
@@ -6,6 +6,7 @@
 //
 
 #include "Parser.hpp"
+#include "Trace.hpp"
 
 
 bool Parser::lex(std::string src) {
@@ -134,6 +135,8 @@ Parser::parseConstraintList(std::string src) {
 }
 
 Parser::AST<Nonogram::Constraints> Parser::parseConstraints(std::string src) {
+	NONOGRAM_TRACE_SCOPE("parseConstraints");
+
 	std::stringstream ss(src);
 	std::string line;
 
@@ -178,13 +181,15 @@ Parser::AST<Nonogram::Constraints> Parser::parseConstraints(std::string src) {
 }
 
 Parser::Maybe<Nonogram::Table> Parser::parseImage(std::string s) {
+	NONOGRAM_TRACE_SCOPE("parseImage");
+
 	Nonogram::Table result;
 	std::stringstream ss(s);
 
 	std::string line;
 	while (std::getline(ss, line)) {
 		try {
-			auto row = _map(line, [=](char ch) {
+			auto row = mapped(line, [=](char ch) {
 				switch (ch) {
 				case '.': return Nonogram::CELL_WHITE;
 				case '*': return Nonogram::CELL_BLACK;
@@ -192,7 +197,8 @@ Parser::Maybe<Nonogram::Table> Parser::parseImage(std::string s) {
 				}
 			});
 
-			result.push_back(row);
+			// converted right into the row, without a temporary vector
+			result.emplace_back(row.begin(), row.end());
 		} catch (const std::exception &e) {
 			return {};
 		}
@@ -214,6 +220,8 @@ Parser::Maybe<Nonogram::Table> Parser::parseImage(std::string s) {
 }
 
 std::string Parser::serializeImage(const Nonogram::Table &table) {
+	NONOGRAM_TRACE_SCOPE("serializeImage");
+
 	std::string str;
 
 	for (const auto &row : table) {
@@ -228,27 +236,24 @@ std::string Parser::serializeImage(const Nonogram::Table &table) {
 }
 
 std::string Parser::serializeConstraints(const Nonogram::Constraints &c) {
+	NONOGRAM_TRACE_SCOPE("serializeConstraints");
+
 	auto n_rows = std::to_string(c.rows.size());
 	auto n_cols = std::to_string(c.cols.size());
 
 	auto serializeClues = [=](const std::vector<int> &v) {
-		auto strings = _map(v, [=](int n) { return std::to_string(n); });
-
 		// The format specification says that an empty row/column
 		// must be represented as "{ 0 }" instead of "{}".
 		// BUT WHY?!
-		if (strings.empty()) {
-			strings = { "0" };
+		if (v.empty()) {
+			return std::string("{ 0 }");
 		}
 
-		return std::string("{ ") + join(strings, " ") + " }";
+		return std::string("{ ") + join(mapped(v, [=](int n) { return std::to_string(n); }), " ") + " }";
 	};
 
-	auto rows = _map(c.rows, serializeClues);
-	auto cols = _map(c.cols, serializeClues);
-
-	auto result = std::string("{ ") + join(rows, " ") + " }\n";
-	result     += std::string("{ ") + join(cols, " ") + " }\n";
+	auto result = std::string("{ ") + join(mapped(c.rows, serializeClues), " ") + " }\n";
+	result     += std::string("{ ") + join(mapped(c.cols, serializeClues), " ") + " }\n";
 
 	return n_cols + ' ' + n_rows + '\n' + result;
 }
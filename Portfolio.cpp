@@ -0,0 +1,122 @@
+//
+// Portfolio.cpp
+// Racing differently configured searches against each other
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include "Portfolio.hpp"
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+
+// Stops a member of the portfolio once another one has won,
+// or when the caller's own stop object says so
+class PortfolioStop : public Gecode::Search::Stop {
+protected:
+	const std::atomic<bool> &done;
+	Gecode::Search::Stop *outer;
+
+public:
+	bool fired;
+
+	PortfolioStop(const std::atomic<bool> &d, Gecode::Search::Stop *o) : done(d), outer(o), fired(false) {}
+
+	virtual bool stop(const Gecode::Search::Statistics &s, const Gecode::Search::Options &o) {
+		fired = fired or done or (outer and outer->stop(s, o));
+		return fired;
+	}
+};
+
+std::vector<PortfolioConfig> defaultPortfolio(std::size_t n, unsigned int seed)
+{
+	auto make = [](std::string name, Nonogram::VariableOrder var, Nonogram::ValueOrder val, unsigned int s, Nonogram::SearchEngine engine, unsigned long scale) {
+		PortfolioConfig config;
+		config.name = name;
+		config.strategy.variableOrder = var;
+		config.strategy.valueOrder = val;
+		config.strategy.seed = s;
+		config.engine = engine;
+		config.restartScale = scale;
+		return config;
+	};
+
+	std::vector<PortfolioConfig> fixed {
+		make("afc/black/dfs",        Nonogram::VAR_AFC_MAX,      Nonogram::VAL_MAX, 0, Nonogram::SEARCH_DFS,     0),
+		make("afc/white/dfs",        Nonogram::VAR_AFC_MAX,      Nonogram::VAL_MIN, 0, Nonogram::SEARCH_DFS,     0),
+		make("activity/black/luby",  Nonogram::VAR_ACTIVITY_MAX, Nonogram::VAL_MAX, 0, Nonogram::SEARCH_RESTART, 100),
+		make("degree/white/dfs",     Nonogram::VAR_DEGREE_MAX,   Nonogram::VAL_MIN, 0, Nonogram::SEARCH_DFS,     0),
+		make("rowmajor/black/dfs",   Nonogram::VAR_ROW_MAJOR,    Nonogram::VAL_MAX, 0, Nonogram::SEARCH_DFS,     0),
+	};
+
+	std::vector<PortfolioConfig> configs;
+
+	for (std::size_t i = 0; i < n; i++) {
+		if (i < fixed.size()) {
+			configs.push_back(fixed[i]);
+			continue;
+		}
+
+		// Beyond the hand-picked ones: random orders with
+		// restarts, alternating between short and long runs
+		unsigned int s = seed + unsigned(i);
+		unsigned long scale = i % 2 ? 50 : 200;
+		std::string name = "random" + std::to_string(s) + "/luby" + std::to_string(scale);
+		configs.push_back(make(name, Nonogram::VAR_RANDOM, Nonogram::VAL_RANDOM, s, Nonogram::SEARCH_RESTART, scale));
+	}
+
+	return configs;
+}
+
+PortfolioResult solvePortfolio(
+	const Nonogram::Constraints &c,
+	const std::vector<PortfolioConfig> &configs,
+	std::size_t nSolutions,
+	Gecode::Search::Stop *stop
+)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	std::atomic<bool> done(false);
+	std::mutex mutex;
+	PortfolioResult result { {}, false, 0, 0 };
+
+	auto start = Clock::now();
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < configs.size(); i++) {
+		threads.emplace_back([&, i] {
+			PortfolioStop memberStop(done, stop);
+			Nonogram::SolveOptions options;
+			options.stop = &memberStop;
+			options.engine = configs[i].engine;
+			options.restartScale = configs[i].restartScale;
+
+			Nonogram n(c, configs[i].strategy);
+			auto solutions = n.solve(nSolutions, nullptr, options);
+
+			// A search that was stopped may have missed solutions
+			if (not memberStop.fired) {
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (not done) {
+					done = true;
+					result.solutions = solutions;
+					result.finished = true;
+					result.winner = i;
+					result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+				}
+			}
+		});
+	}
+
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	return result;
+}
@@ -0,0 +1,58 @@
+//
+// Portfolio.hpp
+// Racing differently configured searches against each other
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#ifndef NONOGRAM_PORTFOLIO_HPP
+#define NONOGRAM_PORTFOLIO_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include "Nonogram.hpp"
+
+// How long a search takes depends enormously on the branching order,
+// and which order is the best one differs from puzzle to puzzle.
+// So we run several differently configured searches at the same time,
+// each on its own thread, and take the answer of whichever finishes
+// first; the others are cancelled.
+//
+// Each configuration is deterministic (random orders are seeded),
+// so the same configuration always finds the same solutions; only
+// which configuration wins may depend on the load of the machine.
+
+struct PortfolioConfig {
+	std::string name;
+	Nonogram::Strategy strategy;
+	Nonogram::SearchEngine engine;
+	unsigned long restartScale; // only used by SEARCH_RESTART
+};
+
+struct PortfolioResult {
+	std::vector<Nonogram::Table> solutions;
+	bool finished;      // false if every search was stopped by 'stop'
+	std::size_t winner; // index of the winning configuration
+	double seconds;     // wall clock time until the winner finished
+};
+
+// 'n' diverse configurations. The first one is the classic
+// AFC/black-first DFS; the rest vary the variable and value orders
+// and the restart schedule, with random seeds derived from 'seed'.
+std::vector<PortfolioConfig> defaultPortfolio(std::size_t n, unsigned int seed = 0);
+
+// Searches for up to 'nSolutions' solutions with every configuration
+// at once and returns the result of the first one that completes.
+// 'stop', if non-null, may cancel the whole portfolio; it is polled
+// concurrently by all the threads, so it must be thread-safe.
+PortfolioResult solvePortfolio(
+	const Nonogram::Constraints &c,
+	const std::vector<PortfolioConfig> &configs,
+	std::size_t nSolutions = 1,
+	Gecode::Search::Stop *stop = nullptr
+);
+
+#endif // NONOGRAM_PORTFOLIO_HPP
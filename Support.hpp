@@ -20,6 +20,9 @@
 #include <algorithm>
 #include <iterator>
 #include <numeric>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
 
 
 template<typename T, template<typename... Types> class C, typename... Types>
@@ -28,38 +31,148 @@ T sum(const C<Types...> &v)
 	return std::accumulate(v.begin(), v.end(), T(0));
 }
 
-template<typename T, typename F, template<typename U, typename... Types> class C, typename... Types>
-std::vector<typename std::result_of<F(T)>::type> _map(const C<T, Types...> &v, F fn)
-{
-	std::vector<typename std::result_of<F(T)>::type> result(v.size());
-	std::transform(v.begin(), v.end(), result.begin(), fn);
-	return result;
-}
+// Lazy views. mapped() and filtered() don't build a new container;
+// they return a range whose iterators apply the function on the fly,
+// when the range is traversed. They can be chained, and a view can be
+// materialized when needed: std::vector<T> v(view.begin(), view.end()).
+// A view only holds iterators into the underlying range (and a copy of
+// the function), so the underlying range must outlive the view.
 
-template<typename F, template<typename... Types> class C, typename... Types>
-C<Types...> filter(const C<Types...> &v, F fn)
-{
-	C<Types...> result;
+template<typename It>
+class Range {
+protected:
+	It first;
+	It last;
+
+public:
+	typedef It iterator;
+	typedef It const_iterator;
+
+	Range(It b, It e) : first(b), last(e) {}
+
+	It begin() const { return first; }
+	It end() const { return last; }
+
+	bool empty() const { return first == last; }
+};
+
+// The iterator category of the views: whatever 'It' is, but at most
+// forward, since the views only ever step forward. A single-pass
+// underlying range yields single-pass views.
+template<typename It>
+struct ViewIteratorCategory {
+	typedef typename std::iterator_traits<It>::iterator_category category;
+	typedef typename std::conditional<
+		std::is_base_of<std::forward_iterator_tag, category>::value,
+		std::forward_iterator_tag,
+		category
+	>::type type;
+};
+
+template<typename It, typename F>
+class MapIterator {
+protected:
+	It it;
+	F fn;
+
+public:
+	typedef typename ViewIteratorCategory<It>::type iterator_category;
+	typedef typename std::decay<decltype(std::declval<const F &>()(*std::declval<It &>()))>::type value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const value_type *pointer;
+	typedef value_type reference; // computed, so returned by value
+
+	MapIterator(It i, F f) : it(i), fn(f) {}
+
+	reference operator*() const { return fn(*it); }
+
+	MapIterator &operator++() {
+		++it;
+		return *this;
+	}
+
+	MapIterator operator++(int) {
+		MapIterator old = *this;
+		++it;
+		return old;
+	}
+
+	bool operator==(const MapIterator &other) const { return it == other.it; }
+	bool operator!=(const MapIterator &other) const { return it != other.it; }
+};
 
-	for (const auto &elem : v) {
-		if (fn(elem)) {
-			result.push_back(elem);
+template<typename It, typename F>
+class FilterIterator {
+protected:
+	It it;
+	It last;
+	F fn;
+
+	void skip() {
+		while (it != last and not fn(*it)) {
+			++it;
 		}
 	}
 
-	return result;
+public:
+	typedef typename ViewIteratorCategory<It>::type iterator_category;
+	typedef typename std::iterator_traits<It>::value_type value_type;
+	typedef typename std::iterator_traits<It>::difference_type difference_type;
+	typedef typename std::iterator_traits<It>::pointer pointer;
+	typedef typename std::iterator_traits<It>::reference reference;
+
+	FilterIterator(It i, It l, F f) : it(i), last(l), fn(f) {
+		skip();
+	}
+
+	reference operator*() const { return *it; }
+
+	FilterIterator &operator++() {
+		++it;
+		skip();
+		return *this;
+	}
+
+	FilterIterator operator++(int) {
+		FilterIterator old = *this;
+		++*this;
+		return old;
+	}
+
+	bool operator==(const FilterIterator &other) const { return it == other.it; }
+	bool operator!=(const FilterIterator &other) const { return it != other.it; }
+};
+
+// The elements of 'r' transformed by 'fn'
+template<typename R, typename F>
+auto mapped(R &&r, F fn) -> Range<MapIterator<decltype(r.begin()), F>>
+{
+	typedef MapIterator<decltype(r.begin()), F> Iterator;
+	return { Iterator(r.begin(), fn), Iterator(r.end(), fn) };
 }
 
-static std::string join(const std::vector<std::string> &v, std::string delim)
+// The elements of 'r' for which 'fn' returns true
+template<typename R, typename F>
+auto filtered(R &&r, F fn) -> Range<FilterIterator<decltype(r.begin()), F>>
 {
-	if (v.size() < 2) {
-		return v.size() ? v[0] : "";
-	}
+	typedef FilterIterator<decltype(r.begin()), F> Iterator;
+	return { Iterator(r.begin(), r.end(), fn), Iterator(r.end(), r.end(), fn) };
+}
+
+// Concatenates a range of strings, separated by 'delim'
+template<typename R>
+std::string join(const R &strings, const std::string &delim)
+{
+	std::string s;
+	bool first = true;
 
-	std::string s = v[0];
+	for (const auto &str : strings) {
+		if (not first) {
+			s += delim;
+		}
 
-	for (auto it = v.cbegin() + 1; it != v.end(); it++) {
-		s += delim + *it;
+		s += str;
+		first = false;
 	}
 
 	return s;
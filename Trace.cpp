@@ -0,0 +1,142 @@
+//
+// Trace.cpp
+// Scoped trace probes, written as Chrome trace-event JSON
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include "Trace.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+
+
+#ifdef NONOGRAM_ENABLE_TRACING
+const bool Trace::compiledIn = true;
+#else
+const bool Trace::compiledIn = false;
+#endif
+
+std::atomic<bool> Trace::active(false);
+std::mutex Trace::mutex;
+std::string Trace::path;
+Trace::Clock::time_point Trace::origin;
+std::vector<std::unique_ptr<Trace::Buffer>> Trace::buffers;
+thread_local Trace::Buffer *Trace::buffer = nullptr;
+
+bool Trace::start(const std::string &file) {
+	if (not compiledIn) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	path = file;
+	origin = Clock::now();
+
+	for (auto &b : buffers) {
+		std::lock_guard<std::mutex> bufferLock(b->mutex);
+		b->events.clear();
+	}
+
+	active = true;
+	return true;
+}
+
+bool Trace::stop() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (not active) {
+		return false;
+	}
+
+	active = false;
+
+	auto microseconds = [](Clock::duration d) {
+		return std::chrono::duration<double, std::micro>(d).count();
+	};
+
+	// Fractional microseconds, without scientific notation
+	std::ofstream f(path);
+	f << std::fixed << std::setprecision(3);
+
+	f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	bool first = true;
+	for (auto &b : buffers) {
+		std::lock_guard<std::mutex> bufferLock(b->mutex);
+
+		if (b->events.empty()) {
+			continue;
+		}
+
+		// One named track per thread...
+		f << (first ? "" : ",\n")
+		  << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->thread
+		  << ",\"args\":{\"name\":\"thread " << b->thread << "\"}}";
+		first = false;
+
+		// ...and one complete ('X') event per probe. The names
+		// are string literals of ours, they needn't be escaped.
+		for (const auto &event : b->events) {
+			// The probe may have started before the trace did
+			if (event.begin < origin) {
+				continue;
+			}
+
+			f << ",\n"
+			  << "{\"name\":\"" << event.name << "\",\"cat\":\"nonogram\",\"ph\":\"X\",\"pid\":1"
+			  << ",\"tid\":" << b->thread
+			  << ",\"ts\":" << microseconds(event.begin - origin)
+			  << ",\"dur\":" << microseconds(event.end - event.begin) << "}";
+		}
+
+		b->events.clear();
+	}
+
+	f << "\n]}\n";
+
+	return bool(f);
+}
+
+Trace::Buffer *Trace::registerThread() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	buffers.emplace_back(new Buffer);
+	buffers.back()->thread = unsigned(buffers.size() - 1);
+
+	return buffers.back().get();
+}
+
+void Trace::record(const char *name, Clock::time_point begin, Clock::time_point end) {
+	if (not isActive()) {
+		return;
+	}
+
+	if (not buffer) {
+		buffer = registerThread();
+	}
+
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	buffer->events.push_back({ name, begin, end });
+}
+
+// NONOGRAM_TRACE=file traces the whole run of the program.
+// Defined after the static members above, so it's constructed
+// after and destroyed before them.
+static struct EnvironmentTrace {
+	EnvironmentTrace() {
+		const char *file = std::getenv("NONOGRAM_TRACE");
+
+		if (file and not Trace::start(file)) {
+			std::cerr << "NONOGRAM_TRACE is set, but the trace probes aren't compiled in (build with `make TRACING=1`)\n";
+		}
+	}
+
+	~EnvironmentTrace() {
+		Trace::stop();
+	}
+} environmentTrace;
@@ -0,0 +1,111 @@
+//
+// Trace.hpp
+// Scoped trace probes, written as Chrome trace-event JSON
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#ifndef NONOGRAM_TRACE_HPP
+#define NONOGRAM_TRACE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+// Where does the time of a solve go? Put NONOGRAM_TRACE_SCOPE("name")
+// at the top of a block, and the time spent in the block is recorded
+// as an event on the track of the calling thread. The recorded events
+// can be loaded into chrome://tracing or https://ui.perfetto.dev.
+//
+// The probes are compiled in only if NONOGRAM_ENABLE_TRACING is defined
+// (`make TRACING=1`); otherwise they expand to nothing. Even then they
+// only record anything between Trace::start() and Trace::stop(), or if
+// the NONOGRAM_TRACE environment variable names the file to write the
+// trace to when the program exits. An idle probe costs an atomic load.
+//
+// Every thread records into a buffer of its own, so the probes of
+// concurrent searches don't contend; stop() merges the buffers. The
+// buffers belong to the tracer, so the events of threads that have
+// already exited are still written.
+class Trace {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+protected:
+	struct Event {
+		const char *name;
+		Clock::time_point begin;
+		Clock::time_point end;
+	};
+
+	// Only locked by stop() besides its own thread
+	struct Buffer {
+		std::mutex mutex;
+		std::vector<Event> events;
+		unsigned int thread; // small id for the track
+	};
+
+	static std::atomic<bool> active;
+	static std::mutex mutex; // guards the members below and start()/stop()
+	static std::string path;
+	static Clock::time_point origin;
+	static std::vector<std::unique_ptr<Buffer>> buffers;
+	static thread_local Buffer *buffer; // of the calling thread, once it has one
+
+	static Buffer *registerThread();
+
+public:
+	// Whether the probes were compiled in (NONOGRAM_ENABLE_TRACING)
+	static const bool compiledIn;
+
+	static bool isActive() { return active.load(std::memory_order_relaxed); }
+
+	// Starts recording, discarding whatever was recorded before.
+	// The trace is written to 'file' by stop(). Returns false, and
+	// records nothing, if the probes weren't compiled in.
+	static bool start(const std::string &file);
+
+	// Stops recording and writes the trace. Returns false if the
+	// file can't be written (or if there was no trace started).
+	static bool stop();
+
+	// 'name' must outlive the trace; pass string literals
+	static void record(const char *name, Clock::time_point begin, Clock::time_point end);
+};
+
+class TraceScope {
+protected:
+	const char *name;
+	bool recording;
+	Trace::Clock::time_point begin;
+
+public:
+	TraceScope(const char *n) : name(n), recording(Trace::isActive()) {
+		if (recording) {
+			begin = Trace::Clock::now();
+		}
+	}
+
+	~TraceScope() {
+		if (recording) {
+			Trace::record(name, begin, Trace::Clock::now());
+		}
+	}
+
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+};
+
+#ifdef NONOGRAM_ENABLE_TRACING
+#define NONOGRAM_TRACE_CONCAT_(a, b) a##b
+#define NONOGRAM_TRACE_CONCAT(a, b) NONOGRAM_TRACE_CONCAT_(a, b)
+#define NONOGRAM_TRACE_SCOPE(name) TraceScope NONOGRAM_TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define NONOGRAM_TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif // NONOGRAM_TRACE_HPP
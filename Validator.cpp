@@ -0,0 +1,213 @@
+//
+// Validator.cpp
+// Incremental uniqueness checking of a table being edited
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include "Validator.hpp"
+
+#include <algorithm>
+
+
+// Adapts a CancelPredicate to Gecode's way of interrupting a search
+class PredicateStop : public Gecode::Search::Stop {
+protected:
+	const Validator::CancelPredicate &cancelled;
+
+public:
+	bool fired;
+
+	PredicateStop(const Validator::CancelPredicate &pred) : cancelled(pred), fired(false) {}
+
+	virtual bool stop(const Gecode::Search::Statistics &, const Gecode::Search::Options &) {
+		fired = fired or (cancelled and cancelled());
+		return fired;
+	}
+};
+
+void Validator::setTable(const Nonogram::Table &t) {
+	std::size_t cols = t.size() ? t[0].size() : 0;
+
+	// Different dimensions: nothing can be reused
+	if (t.size() != table.size() or cols != (table.size() ? table[0].size() : 0)) {
+		table = t;
+		engine.reset();
+		return;
+	}
+
+	for (std::size_t i = 0; i < t.size(); i++) {
+		for (std::size_t j = 0; j < cols; j++) {
+			if (table[i][j] != t[i][j]) {
+				setCell(i, j, t[i][j]);
+			}
+		}
+	}
+}
+
+void Validator::setCell(std::size_t row, std::size_t col, Nonogram::Cell value) {
+	table[row][col] = value;
+
+	if (engine) {
+		dirtyRows[row] = true;
+		dirtyCols[col] = true;
+	}
+}
+
+Validator::Status Validator::check(const CancelPredicate &cancelled) {
+	std::size_t rows = table.size();
+	std::size_t cols = rows ? table[0].size() : 0;
+
+	if (not engine) {
+		engine.reset(new HintEngine(Nonogram::constraintsFromTable(table)));
+		dirtyRows.assign(rows, false);
+		dirtyCols.assign(cols, false);
+	}
+
+	// Bring the clues of the edited lines up to date
+	for (std::size_t i = 0; i < rows; i++) {
+		if (dirtyRows[i]) {
+			engine->setRowClues(i, Nonogram::blockSizesOfLine(table[i]));
+			dirtyRows[i] = false;
+		}
+	}
+
+	std::vector<Nonogram::Cell> column(rows);
+	for (std::size_t j = 0; j < cols; j++) {
+		if (dirtyCols[j]) {
+			for (std::size_t i = 0; i < rows; i++) {
+				column[i] = table[i][j];
+			}
+
+			engine->setColClues(j, Nonogram::blockSizesOfLine(column));
+			dirtyCols[j] = false;
+		}
+	}
+
+	// Most hand-drawn images are either line-solvable (hence unique),
+	// or they aren't, in which case we need to search for 2 solutions.
+	// The table itself is always a solution, so propagation can't fail.
+	// Starting from scratch keeps it sound when an edit makes cells
+	// ambiguous; the lines the edit didn't reach are answered from
+	// the engine's memory of the previous check.
+	Nonogram::Table grid(rows, std::vector<Nonogram::Cell>(cols, Nonogram::CELL_UNKNOWN));
+	engine->propagate(grid);
+
+	bool solvedByLineLogic = std::all_of(grid.begin(), grid.end(), [=](const std::vector<Nonogram::Cell> &row) {
+		return std::none_of(row.begin(), row.end(), [=](Nonogram::Cell cell) {
+			return cell == Nonogram::CELL_UNKNOWN;
+		});
+	});
+
+	if (solvedByLineLogic) {
+		return STATUS_UNIQUE;
+	}
+
+	if (cancelled and cancelled()) {
+		return STATUS_UNSOLVED;
+	}
+
+	// The table itself is the first solution the search should find
+	PredicateStop stop(cancelled);
+	Nonogram::SolveOptions options;
+	options.stop = &stop;
+	options.hint = &table;
+
+	Nonogram n(engine->getConstraints());
+	auto solutions = n.solve(2, nullptr, options);
+
+	if (solutions.size() > 1) {
+		return STATUS_AMBIGUOUS;
+	}
+
+	return stop.fired ? STATUS_UNSOLVED : STATUS_UNIQUE;
+}
+
+
+BackgroundValidator::BackgroundValidator(Callback cb, std::chrono::milliseconds delay) :
+	callback(cb),
+	debounce(delay),
+	pending(false),
+	currentStatus(Validator::STATUS_UNSOLVED),
+	generation(0),
+	quit(false)
+{
+	worker = std::thread([this] { run(); });
+}
+
+BackgroundValidator::~BackgroundValidator() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+
+	cond.notify_all();
+	worker.join();
+}
+
+void BackgroundValidator::tableChanged(const Nonogram::Table &t) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		latest = t;
+		pending = true;
+		generation++;
+
+		if (currentStatus != Validator::STATUS_UNSOLVED) {
+			currentStatus = Validator::STATUS_UNSOLVED;
+
+			if (callback) {
+				callback(currentStatus);
+			}
+		}
+	}
+
+	cond.notify_all();
+}
+
+Validator::Status BackgroundValidator::status() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return currentStatus;
+}
+
+void BackgroundValidator::run() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (true) {
+		cond.wait(lock, [this] { return quit or pending; });
+
+		// Wait until the user stops editing for a while
+		std::size_t seen;
+		do {
+			seen = generation;
+			cond.wait_for(lock, debounce, [&] { return quit or generation != seen; });
+		} while (not quit and generation != seen);
+
+		if (quit) {
+			return;
+		}
+
+		pending = false;
+		validator.setTable(latest);
+		std::size_t current = generation;
+
+		lock.unlock();
+
+		// Abandon the check as soon as it becomes outdated
+		auto status = validator.check([this, current] {
+			return quit or generation != current;
+		});
+
+		lock.lock();
+
+		if (generation != current or status == Validator::STATUS_UNSOLVED) {
+			continue;
+		}
+
+		currentStatus = status;
+
+		if (callback) {
+			callback(status);
+		}
+	}
+}
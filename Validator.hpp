@@ -0,0 +1,103 @@
+//
+// Validator.hpp
+// Incremental uniqueness checking of a table being edited
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#ifndef NONOGRAM_VALIDATOR_HPP
+#define NONOGRAM_VALIDATOR_HPP
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include "Nonogram.hpp"
+#include "HintEngine.hpp"
+
+// Decides whether the clues of a table (an image drawn by the user)
+// describe that table uniquely. It's incremental: after an edit, only
+// the clues of the changed rows and columns are recomputed. Line logic
+// is then replayed from an empty table, but every line that goes
+// through the same inputs as in the previous check reuses its results
+// instead of being solved again, so only the lines the edit reaches
+// cost anything. Only when line logic isn't enough does it fall back
+// to a full Gecode search.
+class Validator {
+public:
+	enum Status {
+		STATUS_UNSOLVED,  // not decided (yet), e. g. the check was cancelled
+		STATUS_UNIQUE,    // the clues have exactly one solution
+		STATUS_AMBIGUOUS  // the clues have more than one solution
+	};
+
+	// Polled during a check; returning true abandons it
+	typedef std::function<bool()> CancelPredicate;
+
+protected:
+	Nonogram::Table table;
+	std::vector<bool> dirtyRows;
+	std::vector<bool> dirtyCols;
+
+	// Holds the clues of 'table' as of the last check,
+	// along with what line logic knows about them
+	std::unique_ptr<HintEngine> engine;
+
+public:
+	// Replaces the table being validated. Only the rows and
+	// columns that differ from the previous table are recomputed.
+	void setTable(const Nonogram::Table &t);
+
+	void setCell(std::size_t row, std::size_t col, Nonogram::Cell value);
+
+	Status check(const CancelPredicate &cancelled = nullptr);
+};
+
+// Runs a Validator on a background thread. Edits are debounced:
+// a check only starts after no edit has arrived for 'debounce' time,
+// and an edit arriving during a check cancels it. The callback is
+// called whenever the status changes, on an arbitrary thread and with
+// an internal lock held (so notifications can't arrive out of order):
+// it should only hand the status over, e. g. using dispatch_async().
+class BackgroundValidator {
+public:
+	typedef std::function<void(Validator::Status)> Callback;
+
+protected:
+	Validator validator; // only ever touched by the worker thread
+	Callback callback;
+	std::chrono::milliseconds debounce;
+
+	std::mutex mutex;
+	std::condition_variable cond;
+	Nonogram::Table latest;
+	bool pending;
+	Validator::Status currentStatus;
+
+	std::atomic<std::size_t> generation;
+	std::atomic<bool> quit;
+
+	std::thread worker;
+
+	void run();
+
+public:
+	BackgroundValidator(Callback cb, std::chrono::milliseconds delay = std::chrono::milliseconds(300));
+	~BackgroundValidator();
+
+	BackgroundValidator(const BackgroundValidator &) = delete;
+	BackgroundValidator &operator=(const BackgroundValidator &) = delete;
+
+	// Schedules a check of 't', superseding any earlier one
+	void tableChanged(const Nonogram::Table &t);
+
+	Validator::Status status();
+};
+
+#endif // NONOGRAM_VALIDATOR_HPP
@@ -0,0 +1,185 @@
+//
+// Verifier.cpp
+// Checking solutions against clues, and extracting clues, on bit-packed tables
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include "Verifier.hpp"
+
+#include <algorithm>
+
+
+void BitTable::assign(const Nonogram::Table &t, bool unknownIsBlack) {
+	nRows = t.size();
+	nCols = nRows ? t[0].size() : 0;
+
+	std::size_t rowWords = wordsFor(nCols);
+	std::size_t colWords = wordsFor(nRows);
+
+	rowBits.assign(nRows * rowWords, 0);
+	colBits.assign(nCols * colWords, 0);
+
+	// The transposed copy is filled in the same pass,
+	// so columns never need to be gathered one by one
+	for (std::size_t i = 0; i < nRows; i++) {
+		std::uint64_t *rowWord = &rowBits[i * rowWords];
+		std::uint64_t colMask = std::uint64_t(1) << (i % 64);
+		std::size_t colWord = i / 64;
+
+		for (std::size_t j = 0; j < nCols; j++) {
+			Nonogram::Cell cell = t[i][j];
+			if (cell == Nonogram::CELL_BLACK or (unknownIsBlack and cell == Nonogram::CELL_UNKNOWN)) {
+				rowWord[j / 64] |= std::uint64_t(1) << (j % 64);
+				colBits[j * colWords + colWord] |= colMask;
+			}
+		}
+	}
+}
+
+std::size_t RunScanner::find(std::size_t from, bool black) const {
+	if (from >= length) {
+		return length;
+	}
+
+	std::size_t wordCount = (length + 63) / 64;
+	std::size_t index = from / 64;
+	std::uint64_t flip = black ? 0 : ~std::uint64_t(0);
+
+	// Mask off the bits before 'from' in the first word
+	std::uint64_t word = (words[index] ^ flip) & (~std::uint64_t(0) << (from % 64));
+
+	while (word == 0) {
+		if (++index >= wordCount) {
+			return length;
+		}
+
+		word = words[index] ^ flip;
+	}
+
+	// Padding bits are zero, so searching for white may
+	// run past the end of the line; clamp to its length
+	return std::min(length, index * 64 + __builtin_ctzll(word));
+}
+
+bool RunScanner::next(int &run) {
+	std::size_t start = find(pos, true);
+	if (start >= length) {
+		pos = length;
+		return false;
+	}
+
+	pos = find(start, false);
+	run = int(pos - start);
+	return true;
+}
+
+bool Verifier::lineMatches(const std::uint64_t *words, std::size_t length, const std::vector<int> &clues) {
+	RunScanner scanner(words, length);
+	std::size_t k = 0;
+	int run;
+
+	while (scanner.next(run)) {
+		if (k >= clues.size() or clues[k] != run) {
+			return false;
+		}
+
+		k++;
+	}
+
+	return k == clues.size();
+}
+
+bool Verifier::lineMatches(const std::vector<Nonogram::Cell> &line, const std::vector<int> &clues) {
+	std::size_t k = 0;
+	std::size_t i = 0;
+
+	while (i < line.size()) {
+		if (line[i] != Nonogram::CELL_BLACK) {
+			i++;
+			continue;
+		}
+
+		std::size_t start = i;
+		while (i < line.size() and line[i] == Nonogram::CELL_BLACK) {
+			i++;
+		}
+
+		if (k >= clues.size() or std::size_t(clues[k]) != i - start) {
+			return false;
+		}
+
+		k++;
+	}
+
+	return k == clues.size();
+}
+
+bool Verifier::verify(const Nonogram::Constraints &c, const Nonogram::Table &t) {
+	std::size_t rows = c.rows.size();
+	std::size_t cols = c.cols.size();
+
+	if (t.size() != rows) {
+		return false;
+	}
+
+	for (const auto &row : t) {
+		if (row.size() != cols) {
+			return false;
+		}
+	}
+
+	packed.assign(t);
+
+	for (std::size_t i = 0; i < rows; i++) {
+		if (not lineMatches(packed.row(i), cols, c.rows[i])) {
+			return false;
+		}
+	}
+
+	for (std::size_t j = 0; j < cols; j++) {
+		if (not lineMatches(packed.col(j), rows, c.cols[j])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::vector<bool> Verifier::verifyBatch(const std::vector<std::pair<Nonogram::Constraints, Nonogram::Table>> &batch) {
+	std::vector<bool> results(batch.size());
+
+	for (std::size_t i = 0; i < batch.size(); i++) {
+		results[i] = verify(batch[i].first, batch[i].second);
+	}
+
+	return results;
+}
+
+Nonogram::Constraints Verifier::extractConstraints(const Nonogram::Table &t) {
+	packed.assign(t, true);
+
+	Nonogram::Constraints c;
+	c.rows.resize(packed.rows());
+	c.cols.resize(packed.cols());
+
+	auto extract = [](const std::uint64_t *words, std::size_t length, std::vector<int> &clues) {
+		RunScanner scanner(words, length);
+		int run;
+
+		while (scanner.next(run)) {
+			clues.push_back(run);
+		}
+	};
+
+	for (std::size_t i = 0; i < packed.rows(); i++) {
+		extract(packed.row(i), packed.cols(), c.rows[i]);
+	}
+
+	for (std::size_t j = 0; j < packed.cols(); j++) {
+		extract(packed.col(j), packed.rows(), c.cols[j]);
+	}
+
+	return c;
+}
@@ -0,0 +1,89 @@
+//
+// Verifier.hpp
+// Checking solutions against clues, and extracting clues, on bit-packed tables
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#ifndef NONOGRAM_VERIFIER_HPP
+#define NONOGRAM_VERIFIER_HPP
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "Nonogram.hpp"
+
+// A table packed into bits, one bit per cell (set = black), stored
+// both row by row and column by column. Each row (column) starts
+// at a word boundary, and the padding bits at the end are zero.
+class BitTable {
+protected:
+	std::size_t nRows;
+	std::size_t nCols;
+	std::vector<std::uint64_t> rowBits;
+	std::vector<std::uint64_t> colBits;
+
+	static inline std::size_t wordsFor(std::size_t bits) { return (bits + 63) / 64; }
+
+public:
+	BitTable() : nRows(0), nCols(0) {}
+
+	// Re-packs 't', reusing the storage of the previous table.
+	// CELL_UNKNOWN is packed as black if 'unknownIsBlack' is set.
+	void assign(const Nonogram::Table &t, bool unknownIsBlack = false);
+
+	inline std::size_t rows() const { return nRows; }
+	inline std::size_t cols() const { return nCols; }
+
+	inline const std::uint64_t *row(std::size_t i) const { return rowBits.data() + i * wordsFor(nCols); }
+	inline const std::uint64_t *col(std::size_t j) const { return colBits.data() + j * wordsFor(nRows); }
+};
+
+// Finds the blocks of a packed line using count-trailing-zeros:
+// the cost is proportional to the number of blocks and words,
+// not to the number of cells.
+class RunScanner {
+protected:
+	const std::uint64_t *words;
+	std::size_t length;
+	std::size_t pos;
+
+	// Position of the first cell at or after 'from' that is black
+	// (or white, if 'black' is false), or 'length' if there's none
+	std::size_t find(std::size_t from, bool black) const;
+
+public:
+	RunScanner(const std::uint64_t *w, std::size_t len) : words(w), length(len), pos(0) {}
+
+	// Stores the length of the next block in 'run';
+	// returns false if there are no more blocks.
+	bool next(int &run);
+};
+
+class Verifier {
+protected:
+	BitTable packed; // reused across calls
+
+	static bool lineMatches(const std::uint64_t *words, std::size_t length, const std::vector<int> &clues);
+
+public:
+	// Does 't' satisfy 'c'? (Dimensions included.)
+	// Cells other than CELL_BLACK count as white.
+	bool verify(const Nonogram::Constraints &c, const Nonogram::Table &t);
+
+	// verify() for each pair in turn. No memory is allocated per line,
+	// only when a table is bigger than all the previous ones.
+	std::vector<bool> verifyBatch(const std::vector<std::pair<Nonogram::Constraints, Nonogram::Table>> &batch);
+
+	// The clues of every row and column of 't'; like
+	// Nonogram::blockSizesOfLine(), non-white cells count as black.
+	Nonogram::Constraints extractConstraints(const Nonogram::Table &t);
+
+	// Unpacked variant of lineMatches(), for single lines
+	static bool lineMatches(const std::vector<Nonogram::Cell> &line, const std::vector<int> &clues);
+};
+
+#endif // NONOGRAM_VERIFIER_HPP
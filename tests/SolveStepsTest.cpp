@@ -0,0 +1,71 @@
+//
+// SolveStepsTest.cpp
+// Recording the search steps while assuming a wrong hint
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+// When the assumed hint is wrong, solve() throws away the steps recorded
+// under the assumption and searches again without it. The fallback must
+// not record into the discarded steps. Build with -fsanitize=address to
+// catch it doing so; without that, the checks below still make sure the
+// steps that are kept belong to the solution that was found.
+//
+
+#include <iostream>
+#include <cstdlib>
+
+#include "Nonogram.hpp"
+
+
+static int failures = 0;
+
+static void expect(bool condition, const char *what)
+{
+	if (not condition) {
+		std::cerr << "FAILED: " << what << '\n';
+		failures++;
+	}
+}
+
+int main()
+{
+	// Its only solution is
+	//   # #
+	//   # .
+	Nonogram::Constraints c;
+	c.rows = { { 2 }, { 1 } };
+	c.cols = { { 2 }, { 1 } };
+
+	// All white: wrong, so the assumed search finds nothing
+	Nonogram::Table hint(2, std::vector<Nonogram::Cell>(2, Nonogram::CELL_WHITE));
+
+	Nonogram::SolveOptions options;
+	options.hint = &hint;
+	options.assumeHint = true;
+
+	std::vector<std::vector<Nonogram::Table>> steps;
+	Nonogram n(c);
+	auto solutions = n.solve(1, &steps, options);
+
+	expect(solutions.size() == 1, "the fallback search finds the solution");
+	expect(steps.size() == solutions.size(), "one list of steps per solution");
+
+	for (const auto &solutionSteps : steps) {
+		for (const auto &step : solutionSteps) {
+			expect(step.size() == 2 and step[0].size() == 2 and step[1].size() == 2, "steps have the size of the puzzle");
+		}
+	}
+
+	// Solving again, without a hint, records the same way
+	steps.clear();
+	solutions = Nonogram(c).solve(1, &steps);
+	expect(solutions.size() == 1 and steps.size() == 1, "solving without a hint still records steps");
+
+	if (failures) {
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "OK\n";
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,574 @@
+//
+// Benchmark.cpp
+// Command-line benchmarks of the solver
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <thread>
+#include <random>
+#include <atomic>
+#include <new>
+
+#include "Nonogram.hpp"
+#include "Parser.hpp"
+#include "Portfolio.hpp"
+#include "Classifier.hpp"
+#include "HintEngine.hpp"
+#include "Trace.hpp"
+
+
+typedef std::chrono::steady_clock Clock;
+
+// Every allocation of the program is counted, for the 'alloc' benchmark
+static std::atomic<std::size_t> allocationCount(0);
+static std::atomic<std::size_t> allocatedBytes(0);
+
+void *operator new(std::size_t size)
+{
+	allocationCount++;
+	allocatedBytes += size;
+
+	if (void *p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+struct Puzzle {
+	std::string name;
+	Nonogram::Constraints constraints;
+};
+
+// Options shared by all benchmarks
+struct Settings {
+	std::size_t repetitions = 5;
+	unsigned long timeLimit = 10000; // in milliseconds, per run
+	std::size_t portfolioSize = std::max(2u, std::thread::hardware_concurrency());
+	unsigned int seed = 0;
+	std::vector<std::size_t> thresholds { 0, 16, 256, 4096 };
+	std::vector<Puzzle> puzzles;
+};
+
+static double millisecondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static double median(std::vector<double> v)
+{
+	if (v.empty()) {
+		return 0;
+	}
+
+	std::sort(v.begin(), v.end());
+	std::size_t n = v.size();
+	return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+static double maximum(const std::vector<double> &v)
+{
+	return v.empty() ? 0 : *std::max_element(v.begin(), v.end());
+}
+
+static bool loadPuzzle(const std::string &path, Puzzle &puzzle)
+{
+	std::ifstream f(path);
+	std::stringstream ss;
+	ss << f.rdbuf();
+
+	Parser parser;
+	auto maybeConstraints = parser.parseConstraints(ss.str());
+	if (not f or not maybeConstraints) {
+		return false;
+	}
+
+	puzzle.name = path.substr(path.find_last_of('/') + 1);
+	puzzle.constraints = maybeConstraints.value;
+	return true;
+}
+
+// Random black and white images of size x size cells, as puzzles
+static std::vector<Puzzle> generatePuzzles(std::size_t count, std::size_t size, unsigned int seed)
+{
+	std::vector<Puzzle> puzzles;
+
+	for (std::size_t k = 0; k < count; k++) {
+		std::mt19937 rng(seed + unsigned(k));
+		std::bernoulli_distribution black(0.5);
+
+		Nonogram::Table table(size, std::vector<Nonogram::Cell>(size));
+		for (auto &row : table) {
+			for (auto &cell : row) {
+				cell = black(rng) ? Nonogram::CELL_BLACK : Nonogram::CELL_WHITE;
+			}
+		}
+
+		std::string name = "random" + std::to_string(size) + "_" + std::to_string(seed + k);
+		puzzles.push_back({ name, Nonogram::constraintsFromTable(table) });
+	}
+
+	return puzzles;
+}
+
+// Solves (i. e. searches for 2 solutions, as the app does) every puzzle
+// with plain DFS and with restart-based search, and reports the median
+// and the worst-case time of each puzzle, and over all the puzzles.
+// Runs that hit the time limit count as taking the time limit.
+static void benchmarkEngines(const Settings &settings)
+{
+	static const std::map<Nonogram::SearchEngine, std::string> engineNames {
+		{ Nonogram::SEARCH_DFS,     "dfs"     },
+		{ Nonogram::SEARCH_RESTART, "restart" }
+	};
+
+	std::printf("%-32s %-8s %12s %12s %8s\n", "puzzle", "engine", "median [ms]", "worst [ms]", "timeouts");
+
+	for (const auto &engine : engineNames) {
+		std::vector<double> medians;
+		std::vector<double> worsts;
+		std::size_t totalTimeouts = 0;
+
+		for (const auto &puzzle : settings.puzzles) {
+			std::vector<double> times;
+			std::size_t timeouts = 0;
+
+			for (std::size_t i = 0; i < settings.repetitions; i++) {
+				Gecode::Search::TimeStop stop(settings.timeLimit);
+				Nonogram::SolveOptions options;
+				options.engine = engine.first;
+				options.stop = &stop;
+
+				auto start = Clock::now();
+				Nonogram n(puzzle.constraints);
+				n.solve(2, nullptr, options);
+				double ms = millisecondsSince(start);
+
+				if (ms >= settings.timeLimit) {
+					timeouts++;
+					ms = settings.timeLimit;
+				}
+
+				times.push_back(ms);
+			}
+
+			std::printf("%-32s %-8s %12.2f %12.2f %8zu\n", puzzle.name.c_str(), engine.second.c_str(), median(times), maximum(times), timeouts);
+
+			medians.push_back(median(times));
+			worsts.push_back(maximum(times));
+			totalTimeouts += timeouts;
+		}
+
+		std::printf("%-32s %-8s %12.2f %12.2f %8zu\n", "(all puzzles)", engine.second.c_str(), median(medians), maximum(worsts), totalTimeouts);
+	}
+}
+
+// Classic DFS against a portfolio of 'portfolioSize' configurations.
+// Reports the median time of both and which configuration won.
+static void benchmarkPortfolio(const Settings &settings)
+{
+	auto configs = defaultPortfolio(settings.portfolioSize, settings.seed);
+
+	std::printf("%-32s %12s %14s  %s\n", "puzzle", "dfs [ms]", "portfolio [ms]", "winners");
+
+	for (const auto &puzzle : settings.puzzles) {
+		std::vector<double> dfsTimes;
+		std::vector<double> portfolioTimes;
+		std::map<std::string, std::size_t> winners;
+
+		for (std::size_t i = 0; i < settings.repetitions; i++) {
+			Gecode::Search::TimeStop dfsStop(settings.timeLimit);
+			Nonogram::SolveOptions options;
+			options.stop = &dfsStop;
+
+			auto start = Clock::now();
+			Nonogram n(puzzle.constraints);
+			n.solve(2, nullptr, options);
+			dfsTimes.push_back(std::min(millisecondsSince(start), double(settings.timeLimit)));
+
+			Gecode::Search::TimeStop portfolioStop(settings.timeLimit);
+
+			start = Clock::now();
+			auto result = solvePortfolio(puzzle.constraints, configs, 2, &portfolioStop);
+			portfolioTimes.push_back(std::min(millisecondsSince(start), double(settings.timeLimit)));
+
+			winners[result.finished ? configs[result.winner].name : "(timeout)"]++;
+		}
+
+		std::string winnerList;
+		for (const auto &winner : winners) {
+			winnerList += winner.first + " (" + std::to_string(winner.second) + ") ";
+		}
+
+		std::printf("%-32s %12.2f %14.2f  %s\n", puzzle.name.c_str(), median(dfsTimes), median(portfolioTimes), winnerList.c_str());
+	}
+}
+
+// Effect of the TupleSet threshold of the hybrid line model on model
+// construction, root propagation and search time, and on the size of
+// the line constraints (TupleSet cells and DFA transitions, in KiB).
+static void benchmarkHybrid(const Settings &settings)
+{
+	std::printf("%-32s %10s %10s %10s %10s %8s %10s\n", "puzzle", "threshold", "build [ms]", "prop [ms]", "solve [ms]", "tables", "size [KiB]");
+
+	for (const auto &puzzle : settings.puzzles) {
+		for (auto threshold : settings.thresholds) {
+			std::vector<double> buildTimes;
+			std::vector<double> propagationTimes;
+			std::vector<double> solveTimes;
+			Nonogram::ConstructionProfile profile {};
+
+			for (std::size_t i = 0; i < settings.repetitions; i++) {
+				Nonogram::Strategy strategy;
+				strategy.tupleSetThreshold = threshold;
+
+				Gecode::Search::TimeStop stop(settings.timeLimit);
+				Nonogram::SolveOptions options;
+				options.stop = &stop;
+
+				auto start = Clock::now();
+				Nonogram n(puzzle.constraints, strategy);
+				buildTimes.push_back(millisecondsSince(start));
+
+				start = Clock::now();
+				n.status();
+				propagationTimes.push_back(millisecondsSince(start));
+
+				start = Clock::now();
+				n.solve(2, nullptr, options);
+				solveTimes.push_back(millisecondsSince(start));
+
+				profile = n.constructionProfile();
+			}
+
+			double kib = (profile.tupleSetCells * sizeof(int) + profile.dfaTransitions * 3 * sizeof(int)) / 1024.0;
+
+			std::printf(
+				"%-32s %10zu %10.2f %10.2f %10.2f %8zu %10.1f\n",
+				puzzle.name.c_str(),
+				threshold,
+				median(buildTimes),
+				median(propagationTimes),
+				median(solveTimes),
+				profile.tupleSetLines,
+				kib
+			);
+		}
+	}
+}
+
+// Re-solving after a small edit. Each run flips a few random cells of
+// a solution of the puzzle, and solves the puzzle described by the
+// edited image from scratch and with the old solution as a hint:
+// searching for 2 solutions (as in a uniqueness check), and for 1
+// solution assuming the hinted cells (falling back if they're wrong).
+static void benchmarkWarmStart(const Settings &settings)
+{
+	static const std::size_t edits = 3;
+
+	std::printf("%-32s %10s %10s %8s %10s %13s %8s\n", "puzzle", "cold2 [ms]", "warm2 [ms]", "speedup", "cold1 [ms]", "assumed1 [ms]", "speedup");
+
+	std::mt19937 rng(settings.seed);
+
+	for (const auto &puzzle : settings.puzzles) {
+		Gecode::Search::TimeStop stop(settings.timeLimit);
+		Nonogram::SolveOptions options;
+		options.stop = &stop;
+
+		auto solutions = Nonogram(puzzle.constraints).solve(1, nullptr, options);
+		if (solutions.empty()) {
+			std::printf("%-32s (no solution found)\n", puzzle.name.c_str());
+			continue;
+		}
+
+		const auto &previous = solutions[0];
+		std::size_t rows = previous.size();
+		std::size_t cols = rows ? previous[0].size() : 0;
+
+		std::vector<double> coldTimes;
+		std::vector<double> warmTimes;
+		std::vector<double> coldOneTimes;
+		std::vector<double> assumedTimes;
+
+		for (std::size_t i = 0; i < settings.repetitions and rows and cols; i++) {
+			auto edited = previous;
+			for (std::size_t k = 0; k < edits; k++) {
+				auto &cell = edited[rng() % rows][rng() % cols];
+				cell = cell == Nonogram::CELL_BLACK ? Nonogram::CELL_WHITE : Nonogram::CELL_BLACK;
+			}
+
+			auto constraints = Nonogram::constraintsFromTable(edited);
+
+			auto timeSolve = [&](std::size_t nSolutions, const Nonogram::Table *hint, bool assume) {
+				Gecode::Search::TimeStop solveStop(settings.timeLimit);
+				Nonogram::SolveOptions solveOptions;
+				solveOptions.stop = &solveStop;
+				solveOptions.hint = hint;
+				solveOptions.assumeHint = assume;
+
+				auto start = Clock::now();
+				Nonogram n(constraints);
+				n.solve(nSolutions, nullptr, solveOptions);
+				return std::min(millisecondsSince(start), double(settings.timeLimit));
+			};
+
+			coldTimes.push_back(timeSolve(2, nullptr, false));
+			warmTimes.push_back(timeSolve(2, &previous, false));
+			coldOneTimes.push_back(timeSolve(1, nullptr, false));
+			assumedTimes.push_back(timeSolve(1, &previous, true));
+		}
+
+		double cold = median(coldTimes);
+		double warm = median(warmTimes);
+		double coldOne = median(coldOneTimes);
+		double assumed = median(assumedTimes);
+
+		std::printf(
+			"%-32s %10.2f %10.2f %7.2fx %10.2f %13.2f %7.2fx\n",
+			puzzle.name.c_str(),
+			cold,
+			warm,
+			warm > 0 ? cold / warm : 0,
+			coldOne,
+			assumed,
+			assumed > 0 ? coldOne / assumed : 0
+		);
+	}
+}
+
+// Latency of the "Hint" command. Each run plays the puzzle from an
+// empty table the way a user asking for hints would: it takes a hint,
+// fills in the cells it names, and asks again, until line logic gets
+// stuck. Reports how many hints a run took, the time of the very first
+// hint (fresh engine, cold line cache), and the median and worst time
+// of a hint over all runs. Like in the app, the shared line cache is
+// kept across runs.
+static void benchmarkHints(const Settings &settings)
+{
+	std::printf("%-32s %8s %10s %12s %11s\n", "puzzle", "hints", "first [ms]", "median [ms]", "worst [ms]");
+
+	std::vector<double> allTimes;
+
+	for (const auto &puzzle : settings.puzzles) {
+		const auto &c = puzzle.constraints;
+		std::vector<double> times;
+		std::size_t hints = 0;
+
+		for (std::size_t i = 0; i < settings.repetitions; i++) {
+			Nonogram::Table table(c.rows.size(), std::vector<Nonogram::Cell>(c.cols.size(), Nonogram::CELL_UNKNOWN));
+			HintEngine engine(c);
+			hints = 0;
+
+			while (true) {
+				auto start = Clock::now();
+				auto hint = engine.nextHint(table);
+				times.push_back(millisecondsSince(start));
+
+				if (hint.status != HintEngine::Hint::HINT_FOUND) {
+					break;
+				}
+
+				for (const auto &cell : hint.cells) {
+					table[cell.row][cell.col] = cell.value;
+				}
+
+				hints++;
+			}
+		}
+
+		std::printf(
+			"%-32s %8zu %10.3f %12.3f %11.3f\n",
+			puzzle.name.c_str(),
+			hints,
+			times.empty() ? 0 : times[0],
+			median(times),
+			maximum(times)
+		);
+
+		allTimes.insert(allTimes.end(), times.begin(), times.end());
+	}
+
+	std::printf("%-32s %8s %10s %12.3f %11.3f\n", "(all puzzles)", "", "", median(allTimes), maximum(allTimes));
+}
+
+// Heap allocations (count and KiB) and time of the non-Gecode helpers
+// that the app runs on every puzzle: classifying the difficulty (which
+// enumerates the configurations of every line), and serializing and
+// parsing the puzzle and (if one is found in time) its solution.
+static void benchmarkAllocations(const Settings &settings)
+{
+	std::printf("%-32s %-10s %10s %10s %10s\n", "puzzle", "function", "allocs", "KiB", "time [ms]");
+
+	auto measure = [&](const std::string &puzzleName, const char *functionName, std::function<void()> fn) {
+		std::size_t count = allocationCount;
+		std::size_t bytes = allocatedBytes;
+		std::vector<double> times;
+
+		for (std::size_t i = 0; i < settings.repetitions; i++) {
+			auto start = Clock::now();
+			fn();
+			times.push_back(millisecondsSince(start));
+		}
+
+		double n = std::max<std::size_t>(settings.repetitions, 1);
+		std::printf(
+			"%-32s %-10s %10.0f %10.1f %10.3f\n",
+			puzzleName.c_str(),
+			functionName,
+			(allocationCount - count) / n,
+			(allocatedBytes - bytes) / n / 1024,
+			median(times)
+		);
+	};
+
+	for (const auto &puzzle : settings.puzzles) {
+		const auto &c = puzzle.constraints;
+		Parser parser;
+
+		measure(puzzle.name, "classify", [&] {
+			configsForAllLines(c.cols.size(), c.rows, 1000);
+			configsForAllLines(c.rows.size(), c.cols, 1000);
+		});
+
+		auto constraintsString = parser.serializeConstraints(c);
+
+		measure(puzzle.name, "serialize", [&] {
+			parser.serializeConstraints(c);
+		});
+
+		measure(puzzle.name, "parse", [&] {
+			parser.parseConstraints(constraintsString);
+		});
+
+		Gecode::Search::TimeStop stop(settings.timeLimit);
+		Nonogram::SolveOptions options;
+		options.stop = &stop;
+
+		auto solutions = Nonogram(c).solve(1, nullptr, options);
+		if (solutions.empty()) {
+			continue;
+		}
+
+		auto image = parser.serializeImage(solutions[0]);
+
+		measure(puzzle.name, "image", [&] {
+			parser.parseImage(image);
+		});
+	}
+}
+
+static void usage(const char *progname)
+{
+	std::cerr << "Usage: " << progname << " <benchmark> [-r repetitions] [-t time limit in ms] [-p portfolio size] [-s seed]\n"
+	          << "       [-k threshold,threshold,...] [-g count:size] [-T file] file.constraint...\n";
+	std::cerr << "-g adds 'count' random puzzles of size x size cells (seeded with -s)\n";
+	std::cerr << "-T writes a Chrome trace of the run to 'file' (needs a build with TRACING=1)\n";
+	std::cerr << "Benchmarks:\n";
+	std::cerr << "  engines    plain DFS vs. restart-based search with nogoods\n";
+	std::cerr << "  portfolio  plain DFS vs. a portfolio of diverse parallel searches\n";
+	std::cerr << "  hybrid     TupleSet vs. DFA line constraints, for each -k threshold\n";
+	std::cerr << "  warmstart  re-solving after small edits, from scratch vs. with the old solution as a hint\n";
+	std::cerr << "  hints      time per hint, playing each puzzle by hints from an empty table\n";
+	std::cerr << "  alloc      heap allocations of classifying, serializing and parsing puzzles\n";
+}
+
+int main(int argc, char *argv[])
+{
+	static const std::map<std::string, std::function<void(const Settings &)>> benchmarks {
+		{ "engines",   benchmarkEngines   },
+		{ "portfolio", benchmarkPortfolio },
+		{ "hybrid",    benchmarkHybrid    },
+		{ "warmstart", benchmarkWarmStart },
+		{ "hints",     benchmarkHints     },
+		{ "alloc",     benchmarkAllocations }
+	};
+
+	if (argc < 2 or not benchmarks.count(argv[1])) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	Settings settings;
+	std::vector<std::string> generate;
+	std::string tracePath;
+
+	for (int i = 2; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "-r" and i + 1 < argc) {
+			settings.repetitions = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-t" and i + 1 < argc) {
+			settings.timeLimit = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-p" and i + 1 < argc) {
+			settings.portfolioSize = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-s" and i + 1 < argc) {
+			settings.seed = unsigned(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "-k" and i + 1 < argc) {
+			settings.thresholds.clear();
+			std::stringstream ss(argv[++i]);
+			std::string threshold;
+			while (std::getline(ss, threshold, ',')) {
+				settings.thresholds.push_back(std::strtoul(threshold.c_str(), nullptr, 10));
+			}
+		} else if (arg == "-g" and i + 1 < argc) {
+			generate.push_back(argv[++i]);
+		} else if (arg == "-T" and i + 1 < argc) {
+			tracePath = argv[++i];
+		} else {
+			Puzzle puzzle;
+			if (not loadPuzzle(arg, puzzle)) {
+				std::cerr << "Can't load puzzle '" << arg << "'\n";
+				return EXIT_FAILURE;
+			}
+
+			settings.puzzles.push_back(puzzle);
+		}
+	}
+
+	// Generated only now, so that -s may come after -g
+	for (const auto &spec : generate) {
+		std::size_t count = std::strtoul(spec.c_str(), nullptr, 10);
+		std::size_t colon = spec.find(':');
+		std::size_t size = colon == std::string::npos ? 0 : std::strtoul(spec.c_str() + colon + 1, nullptr, 10);
+
+		auto generated = generatePuzzles(count, size, settings.seed);
+		settings.puzzles.insert(settings.puzzles.end(), generated.begin(), generated.end());
+	}
+
+	if (settings.puzzles.empty()) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (tracePath.size() and not Trace::start(tracePath)) {
+		std::cerr << "The trace probes aren't compiled in, no trace is written (build with `make TRACING=1`)\n";
+		tracePath.clear();
+	}
+
+	benchmarks.at(argv[1])(settings);
+
+	if (tracePath.size() and not Trace::stop()) {
+		std::cerr << "Can't write trace to '" << tracePath << "'\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+//
+// LoadGenerator.cpp
+// Open-loop load generator for the solver daemon
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+// For each requested rate, requests are scheduled at evenly spaced
+// points in time for the given duration, cycling through the puzzles.
+// Latency is measured from the scheduled send time rather than from the
+// actual one, so a saturated server can't hide its queueing delay by
+// slowing the client down. Reports the throughput of successfully
+// answered requests and the p50/p99 latencies at each rate.
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <csignal>
+
+#include "UnixSocket.hpp"
+
+
+typedef std::chrono::steady_clock Clock;
+
+struct Sample {
+	double latency; // in milliseconds
+	std::string status;
+};
+
+static double percentile(std::vector<double> v, double p)
+{
+	if (v.empty()) {
+		return 0;
+	}
+
+	std::sort(v.begin(), v.end());
+	std::size_t index = std::min(v.size() - 1, std::size_t(p * v.size()));
+	return v[index];
+}
+
+static Sample sendRequest(const std::string &socketPath, const std::string &request, Clock::time_point scheduled)
+{
+	std::string response;
+	int fd = connectTo(socketPath);
+
+	if (fd >= 0) {
+		// A busy server answers and hangs up without reading the
+		// request, so the response is read even if sending failed
+		writeAll(fd, request);
+		shutdown(fd, SHUT_WR);
+		readAll(fd, response);
+
+		close(fd);
+	}
+
+	double latency = std::chrono::duration<double, std::milli>(Clock::now() - scheduled).count();
+
+	// First line is "status <status>"
+	std::string status = "failed";
+	if (response.compare(0, 7, "status ") == 0) {
+		status = response.substr(7, response.find('\n') - 7);
+	}
+
+	return { latency, status };
+}
+
+static void runStep(
+	const std::string &socketPath,
+	const std::vector<std::string> &requests,
+	double rate,
+	double duration,
+	std::size_t concurrency
+)
+{
+	std::size_t total = std::max(std::size_t(1), std::size_t(rate * duration));
+	std::atomic<std::size_t> next(0);
+	std::mutex mutex;
+	std::vector<Sample> samples;
+
+	auto start = Clock::now();
+
+	// Each client thread picks the next scheduled request,
+	// waits for its time to come, and sends it
+	std::vector<std::thread> clients;
+	for (std::size_t i = 0; i < concurrency; i++) {
+		clients.emplace_back([&] {
+			std::size_t k;
+			while ((k = next++) < total) {
+				auto offset = std::chrono::duration<double>(k / rate);
+				auto scheduled = start + std::chrono::duration_cast<Clock::duration>(offset);
+				std::this_thread::sleep_until(scheduled);
+
+				auto sample = sendRequest(socketPath, requests[k % requests.size()], scheduled);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				samples.push_back(sample);
+			}
+		});
+	}
+
+	for (auto &client : clients) {
+		client.join();
+	}
+
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::vector<double> latencies;
+	std::map<std::string, std::size_t> statuses;
+	for (const auto &sample : samples) {
+		statuses[sample.status]++;
+
+		if (sample.status == "unique" or sample.status == "ambiguous" or sample.status == "nosolution") {
+			latencies.push_back(sample.latency);
+		}
+	}
+
+	std::printf(
+		"%10.1f %12.1f %10.2f %10.2f",
+		rate,
+		latencies.size() / elapsed,
+		percentile(latencies, 0.50),
+		percentile(latencies, 0.99)
+	);
+
+	for (const auto &status : statuses) {
+		std::printf("  %s=%zu", status.first.c_str(), status.second);
+	}
+
+	std::printf("\n");
+	std::fflush(stdout);
+}
+
+static void usage(const char *progname)
+{
+	std::cerr << "Usage: " << progname << " [-r rate,rate,...] [-s seconds per rate] [-c client threads] [-d deadline in ms] socket file.constraint...\n";
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<double> rates { 10, 20, 50, 100, 200, 500 };
+	double duration = 5;
+	std::size_t concurrency = 64;
+	unsigned long deadline = 5000;
+	std::string socketPath;
+	std::vector<std::string> requests;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "-r" and i + 1 < argc) {
+			rates.clear();
+			std::stringstream ss(argv[++i]);
+			std::string rate;
+			while (std::getline(ss, rate, ',')) {
+				rates.push_back(std::strtod(rate.c_str(), nullptr));
+			}
+		} else if (arg == "-s" and i + 1 < argc) {
+			duration = std::strtod(argv[++i], nullptr);
+		} else if (arg == "-c" and i + 1 < argc) {
+			concurrency = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-d" and i + 1 < argc) {
+			deadline = std::strtoul(argv[++i], nullptr, 10);
+		} else if (socketPath.empty()) {
+			socketPath = arg;
+		} else {
+			std::ifstream f(arg);
+			std::stringstream ss;
+			ss << f.rdbuf();
+
+			if (not f) {
+				std::cerr << "Can't read '" << arg << "'\n";
+				return EXIT_FAILURE;
+			}
+
+			requests.push_back(std::to_string(deadline) + '\n' + ss.str());
+		}
+	}
+
+	if (socketPath.empty() or requests.empty() or concurrency == 0
+	 or std::any_of(rates.begin(), rates.end(), [](double rate) { return rate <= 0; })) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::signal(SIGPIPE, SIG_IGN);
+
+	std::printf("%10s %12s %10s %10s  %s\n", "rate [1/s]", "throughput", "p50 [ms]", "p99 [ms]", "statuses");
+
+	for (double rate : rates) {
+		runStep(socketPath, requests, rate, duration, concurrency);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,354 @@
+//
+// SolverDaemon.cpp
+// Long-running solver service listening on a Unix domain socket
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+// Connections are accepted by a single acceptor thread and put into a
+// bounded queue; if the queue is full, the connection is rejected right
+// away with "status busy" (admission control). A fixed pool of worker
+// threads takes connections off the queue, so at most that many puzzles
+// are being solved at any time. The worker reads the request itself,
+// within a total time limit and up to a maximum size, so a slow client
+// holds up only that worker, and only for a bounded time, never the
+// acceptor. Every request carries its own deadline, counted from when
+// it was accepted, which is enforced on solving only: requests that
+// expired while queued are not solved at all, and the search is
+// stopped when it runs out.
+//
+// Workers are long-lived, so their DFA cache shards stay warm; solved
+// puzzles are remembered in an LRU cache keyed by the normalized
+// constraints, so repeated puzzles are answered without any search.
+// See UnixSocket.hpp for the protocol.
+//
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
+#include <csignal>
+
+#include "Nonogram.hpp"
+#include "Parser.hpp"
+#include "UnixSocket.hpp"
+
+
+typedef std::chrono::steady_clock Clock;
+
+// Limits on reading a request, counted from the moment a worker
+// starts reading it, so time spent in the queue doesn't count
+static const std::chrono::milliseconds readTimeout(2000);
+static const std::size_t maxRequestSize = 1 << 20;
+
+struct Job {
+	int fd;
+	std::string puzzle;
+	Clock::time_point received;
+	Clock::time_point deadline; // known once the request has been read
+};
+
+class JobQueue {
+protected:
+	std::deque<Job> jobs;
+	std::size_t capacity;
+	std::mutex mutex;
+	std::condition_variable cond;
+
+public:
+	JobQueue(std::size_t cap) : capacity(cap) {}
+
+	// Returns false if the queue is full
+	bool tryPush(const Job &job) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (jobs.size() >= capacity) {
+				return false;
+			}
+
+			jobs.push_back(job);
+		}
+
+		cond.notify_one();
+		return true;
+	}
+
+	Job pop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this] { return not jobs.empty(); });
+
+		Job job = jobs.front();
+		jobs.pop_front();
+		return job;
+	}
+};
+
+// A TimeStop that remembers whether it actually stopped the search,
+// so a timeout isn't confused with a search that happened to finish
+// right around the deadline
+class DeadlineStop : public Gecode::Search::Stop {
+protected:
+	Gecode::Search::TimeStop timeStop;
+
+public:
+	bool fired;
+
+	DeadlineStop(unsigned long milliseconds) : timeStop(milliseconds), fired(false) {}
+
+	virtual bool stop(const Gecode::Search::Statistics &s, const Gecode::Search::Options &o) {
+		fired = fired or timeStop.stop(s, o);
+		return fired;
+	}
+};
+
+struct Result {
+	std::string status;
+	std::string image;
+};
+
+// Least recently used results, keyed by normalized constraints
+class ResultCache {
+protected:
+	typedef std::list<std::pair<std::string, Result>> Entries;
+
+	Entries entries; // most recently used first
+	std::unordered_map<std::string, Entries::iterator> index;
+	std::size_t capacity;
+	std::mutex mutex;
+
+public:
+	ResultCache(std::size_t cap) : capacity(cap) {}
+
+	bool get(const std::string &key, Result &result) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = index.find(key);
+		if (it == index.end()) {
+			return false;
+		}
+
+		entries.splice(entries.begin(), entries, it->second);
+		result = it->second->second;
+		return true;
+	}
+
+	void put(const std::string &key, const Result &result) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (capacity == 0 or index.count(key)) {
+			return;
+		}
+
+		entries.push_front({ key, result });
+		index[key] = entries.begin();
+
+		if (entries.size() > capacity) {
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+	}
+};
+
+static double millisecondsBetween(Clock::time_point from, Clock::time_point to)
+{
+	return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+static void respond(const Job &job, const Result &result, Clock::time_point started, bool cached)
+{
+	auto now = Clock::now();
+
+	std::stringstream ss;
+	ss << "status " << result.status << '\n';
+	ss << "timings queue_ms=" << millisecondsBetween(job.received, started);
+	ss << " solve_ms=" << millisecondsBetween(started, now);
+	ss << " total_ms=" << millisecondsBetween(job.received, now);
+	ss << " cached=" << cached << '\n';
+	ss << result.image;
+
+	writeAll(job.fd, ss.str());
+	close(job.fd);
+}
+
+// Reads the request of 'job' and fills in its deadline and puzzle;
+// the deadline is the client's, so it's counted from 'received'
+static ReadStatus readRequest(Job &job, unsigned long defaultDeadline)
+{
+	std::string request;
+	ReadStatus status = readAllWithin(job.fd, request, maxRequestSize, Clock::now() + readTimeout);
+	if (status != READ_OK) {
+		return status;
+	}
+
+	// First line: deadline in milliseconds (0 = server default)
+	std::size_t newline = request.find('\n');
+	unsigned long deadline = std::strtoul(request.substr(0, newline).c_str(), nullptr, 10);
+	job.deadline = job.received + std::chrono::milliseconds(deadline ? deadline : defaultDeadline);
+	job.puzzle = newline == std::string::npos ? "" : request.substr(newline + 1);
+
+	return READ_OK;
+}
+
+static void serve(Job job, ResultCache &cache, unsigned long defaultDeadline)
+{
+	switch (readRequest(job, defaultDeadline)) {
+	case READ_OK:
+		break;
+	case READ_TIMEOUT:
+		respond(job, { "timeout", "" }, Clock::now(), false);
+		return;
+	case READ_TOO_LONG:
+		respond(job, { "error", "" }, Clock::now(), false);
+		return;
+	case READ_ERROR:
+		close(job.fd);
+		return;
+	}
+
+	auto started = Clock::now();
+
+	if (started >= job.deadline) {
+		respond(job, { "timeout", "" }, started, false);
+		return;
+	}
+
+	Parser parser;
+	auto maybeConstraints = parser.parseConstraints(job.puzzle);
+	if (not maybeConstraints) {
+		respond(job, { "error", "" }, started, false);
+		return;
+	}
+
+	// The serialized form doesn't depend on whitespace
+	// and the like, so it makes a good cache key
+	auto key = parser.serializeConstraints(maybeConstraints.value);
+
+	Result result;
+	if (cache.get(key, result)) {
+		respond(job, result, started, true);
+		return;
+	}
+
+	auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(job.deadline - started);
+	DeadlineStop stop(remaining.count());
+	Nonogram::SolveOptions options;
+	options.stop = &stop;
+
+	Nonogram n(maybeConstraints.value);
+	auto solutions = n.solve(2, nullptr, options);
+
+	// Finding 2 solutions settles the question even if the search
+	// was stopped afterwards; otherwise a stopped search may have
+	// missed solutions
+	bool timedOut = solutions.size() < 2 and stop.fired;
+
+	if (timedOut) {
+		result.status = "timeout";
+	} else if (solutions.empty()) {
+		result.status = "nosolution";
+	} else {
+		result.status = solutions.size() == 1 ? "unique" : "ambiguous";
+	}
+
+	if (solutions.size()) {
+		result.image = parser.serializeImage(solutions[0]);
+	}
+
+	// A timeout says nothing about the puzzle itself
+	if (not timedOut) {
+		cache.put(key, result);
+	}
+
+	respond(job, result, started, false);
+}
+
+static void usage(const char *progname)
+{
+	std::cerr << "Usage: " << progname << " [-w workers] [-q queue capacity] [-c result cache size] [-d default deadline in ms] socket\n";
+}
+
+int main(int argc, char *argv[])
+{
+	std::size_t workers = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
+	std::size_t queueCapacity = 64;
+	std::size_t cacheSize = 1024;
+	unsigned long defaultDeadline = 5000;
+	std::string path;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "-w" and i + 1 < argc) {
+			workers = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-q" and i + 1 < argc) {
+			queueCapacity = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-c" and i + 1 < argc) {
+			cacheSize = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-d" and i + 1 < argc) {
+			defaultDeadline = std::strtoul(argv[++i], nullptr, 10);
+		} else {
+			path = arg;
+		}
+	}
+
+	if (path.empty() or workers == 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Clients hanging up early must not kill the server
+	std::signal(SIGPIPE, SIG_IGN);
+
+	sockaddr_un addr;
+	if (not makeSocketAddress(path, addr)) {
+		std::cerr << "Socket path too long: " << path << '\n';
+		return EXIT_FAILURE;
+	}
+
+	unlink(path.c_str());
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0
+	 or bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof addr) < 0
+	 or listen(listener, 128) < 0) {
+		std::cerr << "Can't listen on " << path << ": " << std::strerror(errno) << '\n';
+		return EXIT_FAILURE;
+	}
+
+	JobQueue queue(queueCapacity);
+	ResultCache cache(cacheSize);
+
+	std::vector<std::thread> pool;
+	for (std::size_t i = 0; i < workers; i++) {
+		pool.emplace_back([&] {
+			while (true) {
+				serve(queue.pop(), cache, defaultDeadline);
+			}
+		});
+	}
+
+	while (true) {
+		int fd = accept(listener, nullptr, nullptr);
+		if (fd < 0) {
+			continue;
+		}
+
+		// The request is read by the worker, see above
+		Job job;
+		job.fd = fd;
+		job.received = Clock::now();
+
+		if (not queue.tryPush(job)) {
+			respond(job, { "busy", "" }, Clock::now(), false);
+		}
+	}
+}
@@ -0,0 +1,157 @@
+//
+// UnixSocket.hpp
+// Minimal helpers for the solver daemon protocol over Unix domain sockets
+//
+// Created by agent on 19/10/2026
+// Licensed under the 3-clause BSD License
+//
+// The protocol is one request per connection, all plain text:
+// the client sends a line with the deadline of the request in
+// milliseconds, followed by the puzzle in the .constraint format,
+// then shuts down its side of the connection for writing.
+// The server answers with a status line ("status <unique|ambiguous|
+// nosolution|timeout|busy|error>"), a timings line ("timings queue_ms=...
+// solve_ms=... total_ms=... cached=<0|1>"), then the first solution
+// in the .table format, if any, and closes the connection.
+//
+
+#ifndef NONOGRAM_TOOLS_UNIXSOCKET_HPP
+#define NONOGRAM_TOOLS_UNIXSOCKET_HPP
+
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+
+// Fills in the address of the socket at 'path'; false if it's too long
+static bool makeSocketAddress(const std::string &path, sockaddr_un &addr)
+{
+	std::memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+
+	if (path.size() >= sizeof addr.sun_path) {
+		return false;
+	}
+
+	std::strcpy(addr.sun_path, path.c_str());
+	return true;
+}
+
+// Reads until EOF (or an error); returns false on error
+static bool readAll(int fd, std::string &out)
+{
+	char buf[4096];
+
+	while (true) {
+		ssize_t n = read(fd, buf, sizeof buf);
+
+		if (n > 0) {
+			out.append(buf, n);
+		} else if (n == 0) {
+			return true;
+		} else if (errno != EINTR) {
+			return false;
+		}
+	}
+}
+
+enum ReadStatus {
+	READ_OK,
+	READ_ERROR,
+	READ_TIMEOUT,  // the deadline passed before EOF
+	READ_TOO_LONG  // more than 'maxSize' bytes were sent
+};
+
+// readAll() for untrusted peers: reads until EOF, but gives up
+// once 'deadline' passes (in total, not per read) or the data
+// would grow beyond 'maxSize' bytes. Data that's already there
+// is read even after the deadline; only waiting for more isn't.
+static ReadStatus readAllWithin(
+	int fd,
+	std::string &out,
+	std::size_t maxSize,
+	std::chrono::steady_clock::time_point deadline
+)
+{
+	char buf[4096];
+
+	while (true) {
+		auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+			deadline - std::chrono::steady_clock::now()
+		).count();
+
+		pollfd pfd { fd, POLLIN, 0 };
+		int ready = poll(&pfd, 1, remaining > 0 ? int(remaining) : 0);
+
+		if (ready < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return READ_ERROR;
+		} else if (ready == 0) {
+			return READ_TIMEOUT;
+		}
+
+		// Readable (or hung up), so this doesn't block
+		ssize_t n = read(fd, buf, sizeof buf);
+
+		if (n > 0) {
+			if (out.size() + n > maxSize) {
+				return READ_TOO_LONG;
+			}
+
+			out.append(buf, n);
+		} else if (n == 0) {
+			return READ_OK;
+		} else if (errno != EINTR) {
+			return READ_ERROR;
+		}
+	}
+}
+
+static bool writeAll(int fd, const std::string &s)
+{
+	std::size_t off = 0;
+
+	while (off < s.size()) {
+		ssize_t n = write(fd, s.data() + off, s.size() - off);
+
+		if (n > 0) {
+			off += n;
+		} else if (n < 0 and errno != EINTR) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Returns a connected socket, or -1
+static int connectTo(const std::string &path)
+{
+	sockaddr_un addr;
+	if (not makeSocketAddress(path, addr)) {
+		return -1;
+	}
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return -1;
+	}
+
+	if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+#endif // NONOGRAM_TOOLS_UNIXSOCKET_HPP